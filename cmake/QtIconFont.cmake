@@ -0,0 +1,114 @@
+# ------ QtIconFont build time helpers, all of them run QtIconFont_tool
+# they are included by the top level CMakeLists.txt when BUILD_TOOLS is ON, which is OFF by default
+
+# qt_iconfont_generate(<target> <json> [NAMESPACE <namespace>] [HEADER <file name>])
+#
+# generate a header with a constexpr glyph table from the iconfont json and add it to <target>.
+# glyphs are resolved at compile time, so typos in class names fail the build:
+#
+#   qt_iconfont_generate(app res/iconfont.json NAMESPACE AppIcons)
+#   #include "iconfont_glyphs.h"
+#   label->setFont(icon_font.font());
+#   label->setText(AppIcons::toString(AppIcons::Glyph::pause));
+#
+# NAMESPACE defaults to the json file name, HEADER defaults to <json name>_glyphs.h
+function(qt_iconfont_generate target json)
+    cmake_parse_arguments(ARG "" "NAMESPACE;HEADER" "" ${ARGN})
+    get_filename_component(json_path "${json}" ABSOLUTE)
+    get_filename_component(json_name "${json}" NAME_WE)
+    if (NOT ARG_NAMESPACE)
+        string(MAKE_C_IDENTIFIER "${json_name}" ARG_NAMESPACE)
+    endif ()
+    if (NOT ARG_HEADER)
+        set(ARG_HEADER "${json_name}_glyphs.h")
+    endif ()
+    set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/qticonfont_generated")
+    set(output "${output_dir}/${ARG_HEADER}")
+
+    add_custom_command(
+            OUTPUT "${output}"
+            COMMAND QtIconFont_tool header --namespace "${ARG_NAMESPACE}" --output "${output}" "${json_path}"
+            DEPENDS "${json_path}" QtIconFont_tool
+            COMMENT "Generating iconfont glyph header ${ARG_HEADER}"
+            VERBATIM
+    )
+    target_sources(${target} PRIVATE "${output}")
+    target_include_directories(${target} PRIVATE "${output_dir}")
+endfunction()
+
+# qt_iconfont_manifest(<target> <json> [OUTPUT <file>])
+#
+# convert the iconfont json to a binary manifest at build time, <target> depends on it.
+# pass the manifest instead of the json to QtIconFont, it is memory-mapped instead of parsed.
+# OUTPUT defaults to ${CMAKE_CURRENT_BINARY_DIR}/<json name>.qifm
+function(qt_iconfont_manifest target json)
+    cmake_parse_arguments(ARG "" "OUTPUT" "" ${ARGN})
+    get_filename_component(json_path "${json}" ABSOLUTE)
+    get_filename_component(json_name "${json}" NAME_WE)
+    if (NOT ARG_OUTPUT)
+        set(ARG_OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/${json_name}.qifm")
+    endif ()
+    get_filename_component(output "${ARG_OUTPUT}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+    get_filename_component(output_name "${output}" NAME)
+
+    add_custom_command(
+            OUTPUT "${output}"
+            COMMAND QtIconFont_tool compile --output "${output}" "${json_path}"
+            DEPENDS "${json_path}" QtIconFont_tool
+            COMMENT "Compiling iconfont manifest ${output_name}"
+            VERBATIM
+    )
+    target_sources(${target} PRIVATE "${output}")
+endfunction()
+
+# qt_iconfont_subset(<target> <font> <json> [CLASSES <name>...] [CLASSES_FILE <file>...]
+#                    [OUTPUT_FONT <file>] [OUTPUT_MANIFEST <file>])
+#
+# reduce a TrueType font to the glyphs the application uses, and emit a matching binary manifest.
+# load the outputs instead of the vendor font and json, class names which are not in the json fail the build:
+#
+#   qt_iconfont_subset(app res/iconfont.ttf res/iconfont.json CLASSES pause memory alert)
+#   QtIconFont icon_font("iconfont_subset.ttf", "iconfont_subset.qifm");
+#
+# OUTPUT_FONT defaults to ${CMAKE_CURRENT_BINARY_DIR}/<font name>_subset.ttf,
+# OUTPUT_MANIFEST defaults to ${CMAKE_CURRENT_BINARY_DIR}/<json name>_subset.qifm
+function(qt_iconfont_subset target font json)
+    cmake_parse_arguments(ARG "" "OUTPUT_FONT;OUTPUT_MANIFEST" "CLASSES;CLASSES_FILE" ${ARGN})
+    if (NOT ARG_CLASSES AND NOT ARG_CLASSES_FILE)
+        message(FATAL_ERROR "qt_iconfont_subset: CLASSES or CLASSES_FILE is required")
+    endif ()
+    get_filename_component(font_path "${font}" ABSOLUTE)
+    get_filename_component(font_name "${font}" NAME_WE)
+    get_filename_component(json_path "${json}" ABSOLUTE)
+    get_filename_component(json_name "${json}" NAME_WE)
+    if (NOT ARG_OUTPUT_FONT)
+        set(ARG_OUTPUT_FONT "${CMAKE_CURRENT_BINARY_DIR}/${font_name}_subset.ttf")
+    endif ()
+    if (NOT ARG_OUTPUT_MANIFEST)
+        set(ARG_OUTPUT_MANIFEST "${CMAKE_CURRENT_BINARY_DIR}/${json_name}_subset.qifm")
+    endif ()
+    get_filename_component(output_font "${ARG_OUTPUT_FONT}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+    get_filename_component(output_manifest "${ARG_OUTPUT_MANIFEST}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+    get_filename_component(output_name "${output_font}" NAME)
+
+    set(class_args)
+    foreach (class_name IN LISTS ARG_CLASSES)
+        list(APPEND class_args --class "${class_name}")
+    endforeach ()
+    set(class_files)
+    foreach (class_file IN LISTS ARG_CLASSES_FILE)
+        get_filename_component(class_file "${class_file}" ABSOLUTE)
+        list(APPEND class_files "${class_file}")
+        list(APPEND class_args --classes-file "${class_file}")
+    endforeach ()
+
+    add_custom_command(
+            OUTPUT "${output_font}" "${output_manifest}"
+            COMMAND QtIconFont_tool subset --font "${font_path}" ${class_args}
+                    --output-font "${output_font}" --output-manifest "${output_manifest}" "${json_path}"
+            DEPENDS "${font_path}" "${json_path}" ${class_files} QtIconFont_tool
+            COMMENT "Subsetting iconfont ${output_name}"
+            VERBATIM
+    )
+    target_sources(${target} PRIVATE "${output_font}" "${output_manifest}")
+endfunction()
@@ -1,28 +1,40 @@
 #ifndef QTICONFONT_SRC_QTICONFONT_H_
 #define QTICONFONT_SRC_QTICONFONT_H_
 
+#include <QColor>
+#include <QFuture>
+#include <QIcon>
 #include <QObject>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QRectF>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QStringView>
 #include "namespace.h"
 
 QT_FORWARD_DECLARE_CLASS(QFile)
 FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtIconFontPrivate)
+FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtIconFontData)
 
 FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
 
+class QtIconFontHandle;
+
 class QtIconFont : public QObject {
  Q_OBJECT
  public:
     /**
      * @brief construct QtIconFont by font's path
      * @param [in] font font file path
-     * @param [in] json json file path
+     * @param [in] json json file path, or a binary manifest created by CompileManifest, which is memory-mapped
      * @param parent
      */
     explicit QtIconFont(const QString &font, const QString &json, QObject *parent = nullptr);
     /**
      * @brief construct QtIconFont by file
      * @param [in] font font file
-     * @param [in] json json file
+     * @param [in] json json file, or a binary manifest created by CompileManifest
      * @param parent
      */
     explicit QtIconFont(QFile *font, QFile *json, QObject *parent = nullptr);
@@ -36,7 +48,37 @@ class QtIconFont : public QObject {
         QString unicode;
         uint32_t unicode_decimal;
     };
+    // shares the ownership of the loaded font, so it stays valid after the font object is gone
     using FontInfoPtr_t = QSharedPointer<FontInfo_t>;
+    struct PixmapCacheStats_t {
+        qint64 hits; // glyphs served without rasterizing, from a tinted pixmap or an alpha mask
+        qint64 misses; // glyphs rasterized
+        qint64 evictions;
+        qint64 bytes; // bytes used by cached pixmaps and masks
+        qint64 limit; // byte budget of the cache
+        int count; // count of cached pixmaps and masks
+    };
+    // time spent in each loading step, in nanoseconds
+    struct LoadTiming_t {
+        qint64 read_ns = 0; // reading or mapping the font and the json or manifest
+        qint64 parse_ns = 0; // parsing the json, 0 for manifests
+        qint64 register_ns = 0; // registering the font to the font database
+    };
+    struct IconColors_t {
+        QColor normal;
+        QColor disabled; // normal color with 40% opacity if invalid
+        QColor active; // normal color if invalid
+        QColor selected; // normal color if invalid
+    };
+    // all rects are relative to the origin on the baseline, y goes down
+    struct GlyphMetrics_t {
+        qreal advance = 0;
+        qreal ascent = 0; // of the font
+        qreal descent = 0; // of the font
+        QRectF bounds; // advance x (ascent + descent) box, the layout cell of the glyph
+        QRectF ink; // bounding rect of the outline
+        [[nodiscard]] bool isValid() const { return !this->bounds.isNull(); }
+    };
 
  public:
     /**
@@ -51,6 +93,39 @@ class QtIconFont : public QObject {
      * @return if the font not loaded, return nullptr
      */
     [[nodiscard]] static QtIconFont *GetIconFont(const QString &font_name);
+    /**
+     * @brief get a refcounted handle of the font by font name, it is safe to call in any thread
+     * @param [in] font_name font name, should be alias name or font name
+     * @return if the font not loaded, return an invalid handle
+     */
+    [[nodiscard]] static QtIconFontHandle AcquireIconFont(const QString &font_name);
+    /**
+     * @brief convert the json file to a binary manifest, which can be memory-mapped instead of parsed at startup
+     * @param [in] json json file path
+     * @param [in] manifest output manifest file path
+     * @return
+     */
+    static bool CompileManifest(const QString &json, const QString &manifest);
+    /**
+     * @brief same as above, only glyphs of the given class names are kept, see QtIconFont_tool subset
+     * @param [in] json json file path
+     * @param [in] manifest output manifest file path
+     * @param [in] font_classes class names of the glyphs to keep, it fails if any of them is not found
+     * @return
+     */
+    static bool CompileManifest(const QString &json, const QString &manifest, const QStringList &font_classes);
+    /**
+     * @brief load font asynchronously, files are read and parsed in the global thread pool,
+     *        only the font registration runs in the gui thread. the font is registered as
+     *        a whole when loading completes, it is never visible half loaded.
+     * @param [in] font font file path
+     * @param [in] json json file path, or a binary manifest created by CompileManifest
+     * @param [in] parent parent of the loaded font. if it is destroyed before loading completes, nothing is loaded
+     * @return the loaded font, or nullptr if failed or if the application is gone before the font is registered.
+     *         the font is deleted with parent, the caller takes the ownership if parent is nullptr.
+     */
+    [[nodiscard]] static QFuture<QtIconFont *> LoadAsync(const QString &font, const QString &json,
+                                                         QObject *parent = nullptr);
 
  public:
     /**
@@ -63,6 +138,11 @@ class QtIconFont : public QObject {
      * @return alias name
      */
     [[nodiscard]] QString aliasName() const;
+    /**
+     * @brief get a refcounted handle of the font, the glyph data lives as long as the handle
+     * @return
+     */
+    [[nodiscard]] QtIconFontHandle handle() const;
 
  public:
     /**
@@ -75,6 +155,11 @@ class QtIconFont : public QObject {
      * @return
      */
     [[nodiscard]] QString fontName() const;
+    /**
+     * @brief get the time spent loading the font, to track startup regressions
+     * @return
+     */
+    [[nodiscard]] LoadTiming_t loadTiming() const;
     /**
      * @brief get the font's description, it is read from json
      * @return
@@ -96,30 +181,158 @@ class QtIconFont : public QObject {
      * @return if not found, return nullptr
      */
     [[nodiscard]] FontInfoPtr_t fontInfoByClass(const QString &name) const;
+    [[nodiscard]] FontInfoPtr_t fontInfoByClass(QStringView name) const;
+    [[nodiscard]] FontInfoPtr_t fontInfoByClass(QLatin1String name) const;
     /**
      * @brief get icon by the icon's class name
      * @param [in] name class name, example: "pause", "memory"
      * @return if not font, returns null char
      */
     [[nodiscard]] QChar iconByClass(const QString &name) const;
+    [[nodiscard]] QChar iconByClass(QStringView name) const;
+    [[nodiscard]] QChar iconByClass(QLatin1String name) const;
     /**
      * @brief get font info by the icon's id
      * @param [in] id icon id, example: "35113170", "35113171"
      * @return if not font, returns null char
      */
     [[nodiscard]] FontInfoPtr_t fontInfoById(const QString &id) const;
+    [[nodiscard]] FontInfoPtr_t fontInfoById(QStringView id) const;
+    [[nodiscard]] FontInfoPtr_t fontInfoById(QLatin1String id) const;
     /**
      * @brief get icon by the icon's id
      * @param [in] id icon id, example: "35113170", "35113171"
      * @return if not font, returns null char
      */
     [[nodiscard]] QChar iconById(const QString &id) const;
+    [[nodiscard]] QChar iconById(QStringView id) const;
+    [[nodiscard]] QChar iconById(QLatin1String id) const;
+
+ public:
+    /**
+     * @brief get the rasterized icon by the icon's class name, the result is cached
+     * @param [in] name class name, example: "pause", "memory"
+     * @param [in] size icon size in device independent pixels
+     * @param [in] color icon color
+     * @param [in] devicePixelRatio device pixel ratio of the target paint device
+     * @return if not found, returns null pixmap
+     */
+    [[nodiscard]] QPixmap pixmap(const QString &name, int size, const QColor &color,
+                                 qreal devicePixelRatio = 1.0) const;
+    /**
+     * @brief get an icon by the icon's class name, it is rendered on demand at the exact requested size
+     *        and device pixel ratio, and the pixmaps are cached in the pixmap cache of the font
+     * @param [in] name class name, example: "pause", "memory"
+     * @param [in] colors icon colors of each QIcon::Mode
+     * @return if not found, returns null icon
+     */
+    [[nodiscard]] QIcon icon(const QString &name, const IconColors_t &colors) const;
+    [[nodiscard]] QIcon icon(const QString &name, const QColor &color) const;
+    /**
+     * @brief get the outline of the icon by the icon's class name, it can be drawn at any size and transform.
+     *        the outline is extracted from the font once and cached, it is safe to call in any thread.
+     * @param [in] name class name, example: "pause", "memory"
+     * @return the outline normalized to the em box: scaled to 1/em, with the baseline at y = ascent / em.
+     *         for most icon fonts the em box is (0, 0, 1, 1). if not found, returns an empty path
+     */
+    [[nodiscard]] QPainterPath path(const QString &name) const;
+    /**
+     * @brief extract the outlines of all icons in the global thread pool, so later calls of path never wait
+     * @return
+     */
+    QFuture<void> preloadPaths() const;
+    /**
+     * @brief get metrics of the icon by the icon's class name, without calling the font engine.
+     *        metrics of all icons are computed once in font units and scaled arithmetically.
+     *        to center an icon in a rect, translate the rect's center by -ink.center() and draw at the result
+     * @param [in] name class name, example: "pause", "memory"
+     * @param [in] pixelSize pixel size of the font
+     * @return if not found, returns invalid metrics
+     */
+    [[nodiscard]] GlyphMetrics_t glyphMetrics(const QString &name, qreal pixelSize) const;
+    /**
+     * @brief set the byte budget of the pixmap cache, least recently used pixmaps are evicted first.
+     *        glyphs are cached once per size and device pixel ratio as 8-bit alpha masks, which are tinted
+     *        on demand. 1/4 of the budget is kept for tinted pixmaps of recently used colors.
+     * @param [in] bytes byte budget, set to 0 to disable caching. the default value is 10MB.
+     */
+    void setPixmapCacheLimit(qint64 bytes);
+    [[nodiscard]] qint64 pixmapCacheLimit() const;
+    /**
+     * @brief get hit/miss/eviction counters of the pixmap cache
+     * @return
+     */
+    [[nodiscard]] PixmapCacheStats_t pixmapCacheStats() const;
+    /**
+     * @brief drop all cached pixmaps, counters are kept
+     */
+    void clearPixmapCache();
+    /**
+     * @brief enable the persistent cache of rasterized icons, it is disabled by default.
+     *        icons found in the cache are read from a memory-mapped pack file instead of being rasterized,
+     *        new icons are saved to it when the application quits, the font is deleted or saveDiskCache is called,
+     *        and every few megabytes of new icons.
+     *        the pack is keyed by the bytes of the font and the manifest, it is replaced when either of them changes.
+     * @param [in] directory cache directory, it is created if needed. set to an empty string to disable
+     * @return false if the font is invalid or the directory cannot be created
+     */
+    bool setDiskCacheDirectory(const QString &directory);
+    [[nodiscard]] QString diskCacheDirectory() const;
+    /**
+     * @brief write new icons to the pack, nothing is written if there are none
+     * @return
+     */
+    bool saveDiskCache();
 
  private:
+    explicit QtIconFont(const QSharedPointer<QtIconFontData> &data, QObject *parent = nullptr);
+
+ private:
+    friend class QtIconFontLoader;
     Q_DECLARE_PRIVATE(QtIconFont);
     QtIconFontPrivate *d_ptr;
 };
 
+/**
+ * @brief refcounted read-only view of a loaded font, it can be used in worker threads.
+ *        the glyph data is not destroyed while a handle exists, even if the QtIconFont object is deleted.
+ */
+class QtIconFontHandle {
+ public:
+    using FontInfoPtr_t = QtIconFont::FontInfoPtr_t;
+
+ public:
+    QtIconFontHandle() = default;
+
+ public:
+    [[nodiscard]] bool isValid() const;
+    explicit operator bool() const { return isValid(); }
+    [[nodiscard]] QString fontName() const;
+    [[nodiscard]] QString fontFamily() const;
+    [[nodiscard]] QFont font() const;
+    /**
+     * @brief same as QtIconFont
+     */
+    [[nodiscard]] FontInfoPtr_t fontInfoByClass(QStringView name) const;
+    [[nodiscard]] FontInfoPtr_t fontInfoByClass(QLatin1String name) const;
+    [[nodiscard]] QChar iconByClass(QStringView name) const;
+    [[nodiscard]] QChar iconByClass(QLatin1String name) const;
+    [[nodiscard]] FontInfoPtr_t fontInfoById(QStringView id) const;
+    [[nodiscard]] FontInfoPtr_t fontInfoById(QLatin1String id) const;
+    [[nodiscard]] QChar iconById(QStringView id) const;
+    [[nodiscard]] QChar iconById(QLatin1String id) const;
+
+ private:
+    friend class QtIconFont;
+    friend class QtIconFontSearch;
+    friend class QtIconFontSet;
+    friend class QtIconLabel;
+    explicit QtIconFontHandle(QSharedPointer<const QtIconFontData> data) : data(std::move(data)) {}
+
+ private:
+    QSharedPointer<const QtIconFontData> data;
+};
+
 FNRICE_QT_WIDGETS_END_NAMESPACE
 
 #endif //QTICONFONT_SRC_QTICONFONT_H_
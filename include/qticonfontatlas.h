@@ -0,0 +1,79 @@
+#ifndef QTICONFONT_SRC_QTICONFONTATLAS_H_
+#define QTICONFONT_SRC_QTICONFONTATLAS_H_
+
+#include <QColor>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+#include "qticonfont.h"
+
+QT_FORWARD_DECLARE_CLASS(QPainter)
+FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtIconFontAtlasPrivate)
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief glyph atlas of one icon font, rasterized glyphs are packed into shared pages,
+ *        so a batch of icons is drawn with one QPainter::drawPixmapFragments call per page.
+ *        it must be used in the gui thread.
+ */
+class QtIconFontAtlas {
+ public:
+    struct Icon_t {
+        QString name; // class name, example: "pause", "memory"
+        QRectF rect; // target rect in logical coordinates
+    };
+    struct Stats_t {
+        int pages;
+        int glyphs;
+        qint64 bytes; // bytes used by pages
+        qint64 limit; // byte budget of pages
+        qint64 evictions; // count of evicted pages
+    };
+
+ public:
+    explicit QtIconFontAtlas(const QtIconFontHandle &font);
+    explicit QtIconFontAtlas(const QtIconFont *font);
+    ~QtIconFontAtlas();
+    QtIconFontAtlas(const QtIconFontAtlas &) = delete;
+    QtIconFontAtlas &operator=(const QtIconFontAtlas &) = delete;
+
+ public:
+    /**
+     * @brief draw icons, glyphs are rasterized into the atlas on first use
+     * @param [in] painter target painter, its device pixel ratio is used
+     * @param [in] icons icons to draw, unknown class names are skipped
+     * @param [in] size rasterized icon size in device independent pixels, icons are scaled to their rects
+     * @param [in] color icon color
+     */
+    void draw(QPainter *painter, const QVector<Icon_t> &icons, int size, const QColor &color);
+    void draw(QPainter *painter, const QRectF &rect, const QString &name, int size, const QColor &color);
+
+ public:
+    /**
+     * @brief set the page size in device pixels, the atlas is cleared
+     * @param [in] size page width and height. the default value is 1024.
+     */
+    void setPageSize(int size);
+    [[nodiscard]] int pageSize() const;
+    /**
+     * @brief set the byte budget of pages, least recently drawn pages are evicted first.
+     *        pages used by the current batch are never evicted, so a batch may exceed the budget.
+     * @param [in] bytes byte budget. the default value is 16MB.
+     */
+    void setMemoryLimit(qint64 bytes);
+    [[nodiscard]] qint64 memoryLimit() const;
+    [[nodiscard]] Stats_t stats() const;
+    /**
+     * @brief drop all pages, counters are kept
+     */
+    void clear();
+
+ private:
+    Q_DECLARE_PRIVATE(QtIconFontAtlas);
+    QtIconFontAtlasPrivate *d_ptr;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTICONFONT_SRC_QTICONFONTATLAS_H_
@@ -0,0 +1,68 @@
+#ifndef QTICONFONT_SRC_QTICONFONTLOADER_H_
+#define QTICONFONT_SRC_QTICONFONTLOADER_H_
+
+#include <QString>
+#include <QVector>
+#include "qticonfont.h"
+
+FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtIconFontLoaderPrivate)
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief load many fonts at startup. files are read and parsed concurrently in the global thread pool,
+ *        only the font registration is serialized in the calling thread, in the order the fonts are added.
+ *        the time spent in each step is recorded per font.
+ */
+class QtIconFontLoader {
+ public:
+    struct Timing_t {
+        QString font; // font file path
+        QString json; // json or manifest file path
+        bool loaded = false;
+        QtIconFont::LoadTiming_t timing;
+    };
+
+ public:
+    QtIconFontLoader();
+    ~QtIconFontLoader();
+    QtIconFontLoader(const QtIconFontLoader &) = delete;
+    QtIconFontLoader &operator=(const QtIconFontLoader &) = delete;
+
+ public:
+    /**
+     * @brief add a font to load
+     * @param [in] font font file path
+     * @param [in] json json file path, or a binary manifest created by QtIconFont::CompileManifest
+     */
+    void addFont(const QString &font, const QString &json);
+    [[nodiscard]] int count() const;
+    /**
+     * @brief load all added fonts and wait until they are registered, must be called in the gui thread.
+     *        a font is registered as soon as it and the fonts added before it are parsed.
+     * @param [in] parent parent of the loaded fonts
+     * @return the loaded fonts in the order they are added, failed ones are skipped.
+     *         the caller takes the ownership if parent is nullptr.
+     */
+    QVector<QtIconFont *> load(QObject *parent = nullptr);
+    /**
+     * @brief get timings of the last load, in the order the fonts are added
+     */
+    [[nodiscard]] QVector<Timing_t> timings() const;
+    /**
+     * @brief get the wall time of the last load in nanoseconds
+     */
+    [[nodiscard]] qint64 elapsed() const;
+    /**
+     * @brief format timings of the last load, one line per font and a total line
+     */
+    [[nodiscard]] QString report() const;
+
+ private:
+    Q_DECLARE_PRIVATE(QtIconFontLoader);
+    QtIconFontLoaderPrivate *d_ptr;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTICONFONT_SRC_QTICONFONTLOADER_H_
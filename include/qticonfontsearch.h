@@ -0,0 +1,66 @@
+#ifndef QTICONFONT_SRC_QTICONFONTSEARCH_H_
+#define QTICONFONT_SRC_QTICONFONTSEARCH_H_
+
+#include <QFuture>
+#include <QString>
+#include <QVector>
+#include "qticonfont.h"
+
+FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtIconFontSearchPrivate)
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief search glyphs by class name and name, for icon pickers which filter on every keystroke.
+ *        the index is built once per font and shared. when a query extends the previous one,
+ *        only the previous results are searched again. a new query supersedes the running one.
+ */
+class QtIconFontSearch {
+ public:
+    enum MatchMode {
+        PrefixMatch, // class name or name starts with the query
+        FuzzyMatch, // query characters appear in order, exact, prefix and substring matches rank first
+    };
+    struct Match_t {
+        QtIconFont::FontInfoPtr_t info;
+        int score;
+    };
+
+ public:
+    explicit QtIconFontSearch(const QtIconFontHandle &font, MatchMode mode = FuzzyMatch);
+    explicit QtIconFontSearch(const QtIconFont *font, MatchMode mode = FuzzyMatch);
+    ~QtIconFontSearch();
+    QtIconFontSearch(const QtIconFontSearch &) = delete;
+    QtIconFontSearch &operator=(const QtIconFontSearch &) = delete;
+
+ public:
+    /**
+     * @brief search glyphs, matching is case insensitive
+     * @param [in] query query text, empty query returns no results
+     * @param [in] limit max count of results, set to a value less than 0 means not limited
+     * @return results sorted by score, best first
+     */
+    [[nodiscard]] QVector<Match_t> search(const QString &query, int limit = -1);
+    /**
+     * @brief same as search, but runs in the global thread pool. the running search is cancelled,
+     *        a cancelled search returns no results
+     */
+    [[nodiscard]] QFuture<QVector<Match_t>> searchAsync(const QString &query, int limit = -1);
+    /**
+     * @brief cancel the running search
+     */
+    void cancel();
+    /**
+     * @brief forget the previous query, the next search starts over all glyphs
+     */
+    void reset();
+    [[nodiscard]] MatchMode matchMode() const;
+
+ private:
+    Q_DECLARE_PRIVATE(QtIconFontSearch);
+    QtIconFontSearchPrivate *d_ptr;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTICONFONT_SRC_QTICONFONTSEARCH_H_
@@ -0,0 +1,89 @@
+#ifndef QTICONFONT_SRC_QTICONFONTSET_H_
+#define QTICONFONT_SRC_QTICONFONTSET_H_
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include "qticonfont.h"
+
+FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtIconFontSetPrivate)
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief several loaded fonts merged under one lookup index.
+ *        a class name or icon id resolves to the glyph of the member with the highest priority,
+ *        members with the same priority fall back in the order they are added.
+ *        lookups are one probe of the merged index. it must be used in one thread.
+ */
+class QtIconFontSet {
+ public:
+    struct Glyph_t {
+        QtIconFont::FontInfoPtr_t info;
+        QtIconFontHandle font; // the member the glyph belongs to
+        [[nodiscard]] bool isValid() const { return !this->info.isNull(); }
+        explicit operator bool() const { return isValid(); }
+        /**
+         * @brief get the glyph as text, draw it with font.font()
+         */
+        [[nodiscard]] QString text() const;
+    };
+
+ public:
+    QtIconFontSet();
+    ~QtIconFontSet();
+    QtIconFontSet(const QtIconFontSet &) = delete;
+    QtIconFontSet &operator=(const QtIconFontSet &) = delete;
+
+ public:
+    /**
+     * @brief add a loaded font
+     * @param [in] font_name font name, should be alias name or font name. it is used to reload the member.
+     * @param [in] priority members with higher priority win when glyphs collide
+     * @return false if the font is not loaded or already in the set
+     */
+    bool addFont(const QString &font_name, int priority = 0);
+    bool addFont(const QtIconFont *font, int priority = 0);
+    /**
+     * @brief remove a member, its glyphs fall back to the other members
+     * @return false if it is not in the set
+     */
+    bool removeFont(const QString &font_name);
+    /**
+     * @brief look up the member again by its name, only its glyphs are reindexed.
+     *        if it is not loaded anymore, it is removed.
+     * @return false if it is not in the set or not loaded anymore
+     */
+    bool reloadFont(const QString &font_name);
+    /**
+     * @brief get names of members, highest priority first
+     */
+    [[nodiscard]] QStringList fonts() const;
+    [[nodiscard]] bool contains(const QString &font_name) const;
+
+ public:
+    /**
+     * @brief get glyph by the icon's class name
+     * @param [in] name class name, example: "pause", "memory"
+     * @return if not found, returns an invalid glyph
+     */
+    [[nodiscard]] Glyph_t glyphByClass(const QString &name) const;
+    [[nodiscard]] Glyph_t glyphByClass(QStringView name) const;
+    [[nodiscard]] Glyph_t glyphByClass(QLatin1String name) const;
+    /**
+     * @brief get glyph by the icon's id
+     * @param [in] id icon id, example: "35113170", "35113171"
+     * @return if not found, returns an invalid glyph
+     */
+    [[nodiscard]] Glyph_t glyphById(const QString &id) const;
+    [[nodiscard]] Glyph_t glyphById(QStringView id) const;
+    [[nodiscard]] Glyph_t glyphById(QLatin1String id) const;
+
+ private:
+    Q_DECLARE_PRIVATE(QtIconFontSet);
+    QtIconFontSetPrivate *d_ptr;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTICONFONT_SRC_QTICONFONTSET_H_
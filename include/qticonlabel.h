@@ -0,0 +1,77 @@
+#ifndef QTICONFONT_SRC_QTICONLABEL_H_
+#define QTICONFONT_SRC_QTICONLABEL_H_
+
+#include <QWidget>
+#include "qticonfont.h"
+
+FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtIconLabelPrivate)
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief a widget which paints one glyph of an icon font, for views with many icons.
+ *        the glyph is rasterized through the pixmap cache of the font, a paint is one pixmap blit.
+ *        the background is only filled when autoFillBackground or WA_OpaquePaintEvent is set.
+ */
+class QtIconLabel : public QWidget {
+ Q_OBJECT
+ public:
+    explicit QtIconLabel(QWidget *parent = nullptr);
+    explicit QtIconLabel(const QtIconFont *font, const QString &name, QWidget *parent = nullptr);
+    ~QtIconLabel() override;
+
+ public:
+    Q_PROPERTY(QString iconName WRITE setIconName READ iconName)
+    Q_PROPERTY(QColor iconColor WRITE setIconColor READ iconColor)
+    Q_PROPERTY(int iconSize WRITE setIconSize READ iconSize)
+    Q_PROPERTY(Qt::Alignment iconAlignment WRITE setIconAlignment READ iconAlignment)
+
+ public:
+    /**
+     * @brief set the font of the icon, the label keeps a handle so the font object may be deleted first
+     * @param [in] font loaded font
+     */
+    void setIconFont(const QtIconFont *font);
+    void setIconFont(const QtIconFontHandle &font);
+    [[nodiscard]] QtIconFontHandle iconFont() const;
+    /**
+     * @brief set the icon by the icon's class name
+     * @param [in] name class name, example: "pause", "memory". nothing is painted if not found
+     */
+    void setIconName(const QString &name);
+    [[nodiscard]] QString iconName() const;
+    /**
+     * @brief set icon color
+     * @param [in] color icon color, the default value is the window text color of the palette
+     */
+    void setIconColor(const QColor &color);
+    [[nodiscard]] QColor iconColor() const;
+    /**
+     * @brief set icon size in device independent pixels, it is also the size hint
+     * @param [in] size icon size, the default value is 16
+     */
+    void setIconSize(int size);
+    [[nodiscard]] int iconSize() const;
+    /**
+     * @brief set icon alignment in the contents rect
+     * @param [in] alignment the default value is Qt::AlignCenter
+     */
+    void setIconAlignment(Qt::Alignment alignment);
+    [[nodiscard]] Qt::Alignment iconAlignment() const;
+
+ public:
+    [[nodiscard]] QSize sizeHint() const override;
+    [[nodiscard]] QSize minimumSizeHint() const override;
+
+ protected:
+    void paintEvent(QPaintEvent *event) override;
+    void changeEvent(QEvent *event) override;
+
+ private:
+    Q_DECLARE_PRIVATE(QtIconLabel);
+    QtIconLabelPrivate *d_ptr;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTICONFONT_SRC_QTICONLABEL_H_
@@ -4,6 +4,7 @@
 #include <QWidget>
 #include "namespace.h"
 
+QT_FORWARD_DECLARE_CLASS(QIODevice)
 FNRICE_QT_WIDGETS_FORWARD_DECLARE_CLASS(QtImageWidgetPrivate)
 
 FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
@@ -29,6 +30,11 @@ class QtImageWidget : public QWidget {
     Q_PROPERTY(QSize imageMinimumPixelSize WRITE setImageMinimumPixelSize READ imageMinimumPixelSize)
     Q_PROPERTY(QSize imageMaximumPixelSize WRITE setImageMaximumPixelSize READ imageMaximumPixelSize)
     Q_PROPERTY(int imageMaximumPercent WRITE setImageMaximumPercent READ imageMaximumPercent)
+    Q_PROPERTY(qint64 imagePyramidLimit WRITE setImagePyramidLimit READ imagePyramidLimit)
+    // tiled image properties
+    Q_PROPERTY(qreal imageZoom WRITE setImageZoom READ imageZoom)
+    Q_PROPERTY(QPointF imagePan WRITE setImagePan READ imagePan)
+    Q_PROPERTY(qint64 tileMemoryLimit WRITE setTileMemoryLimit READ tileMemoryLimit)
 
  public: // ------ basic properties
     /**
@@ -37,6 +43,36 @@ class QtImageWidget : public QWidget {
      */
     void setPixmap(const QPixmap &pixmap);
     [[nodiscard]] QPixmap pixmap() const;
+    /**
+     * @brief set background image from a file. it is decoded in the global thread pool directly at the size
+     *        the widget needs, so the full resolution image is never kept. it is decoded again only when
+     *        the widget grows past the decoded resolution. pixmap() returns the decoded image.
+     * @param [in] file_name image file path, the file is read again on each decode
+     * @return false if the image cannot be read
+     */
+    bool setImageSource(const QString &file_name);
+    /**
+     * @brief set background image from a device, see setImageSource(const QString &)
+     * @param [in] device a readable device, the encoded bytes are read at once and the device is not used later
+     * @return false if the image cannot be read
+     */
+    bool setImageSource(QIODevice *device);
+    /**
+     * @brief set background image from a file which is too large to be decoded at once, and show it in tiles.
+     *        only the tiles in view are decoded, at the level of detail matching imageZoom, in the global thread pool.
+     *        a coarser tile is shown until a tile is loaded, and tiles ahead of the panning or zooming are prefetched.
+     *        the image is placed by imageZoom and imagePan instead of the image properties.
+     *        formats the reader decodes regions of natively (jpeg) are read partially for each tile,
+     *        other formats are decoded whole for each tile, one tile at a time.
+     * @param [in] file_name image file path, the file is read again for each tile
+     * @return false if the image cannot be read, or if its format cannot be decoded partially
+     *         and the whole image exceeds QImageReader::allocationLimit
+     */
+    bool setTiledImageSource(const QString &file_name);
+    /**
+     * @brief get the size of the image set by setImageSource or setTiledImageSource, or the size of the pixmap
+     */
+    [[nodiscard]] QSize imageSourceSize() const;
 
  public: // ------ border properties
     /**
@@ -104,6 +140,23 @@ class QtImageWidget : public QWidget {
      */
     void setImageMaximumPercent(int percent);
     [[nodiscard]] int imageMaximumPercent() const;
+    /**
+     * @brief set the memory limit of downscaled levels kept for large images.
+     *        each rescale starts from the smallest kept level which is not smaller than the target,
+     *        so resizing costs roughly proportional to the target size.
+     * @param [in] bytes memory limit, levels beyond it are built when needed but not kept. the default value is 64MB.
+     *        it takes effect from the next pixmap
+     */
+    void setImagePyramidLimit(qint64 bytes);
+    [[nodiscard]] qint64 imagePyramidLimit() const;
+    /**
+     * @brief set the memory limit of scaled images shared by all image widgets.
+     *        widgets showing the same pixmap at the same size share one scaled image and one scaling job,
+     *        images no widget shows any more are kept within the limit. must be called in the gui thread.
+     * @param [in] bytes memory limit, images in use are kept beyond it. the default value is 128MB.
+     */
+    static void setSharedCacheLimit(qint64 bytes);
+    [[nodiscard]] static qint64 sharedCacheLimit();
     /**
      * @brief set image margins
      * @param [in] left   margin left
@@ -113,6 +166,26 @@ class QtImageWidget : public QWidget {
      */
     void setImageMargins(int left, int right, int top, int bottom);
 
+ public: // ------ tiled image properties
+    /**
+     * @brief set the zoom of the tiled image
+     * @param [in] zoom widget pixels per image pixel. the default value is 1.
+     */
+    void setImageZoom(qreal zoom);
+    [[nodiscard]] qreal imageZoom() const;
+    /**
+     * @brief set the point of the tiled image shown at the center of the widget
+     * @param [in] pos position in image pixels, it is set to the image center by setTiledImageSource
+     */
+    void setImagePan(const QPointF &pos);
+    [[nodiscard]] QPointF imagePan() const;
+    /**
+     * @brief set the memory limit of decoded tiles, the least recently painted are dropped first
+     * @param [in] bytes memory limit. the default value is 128MB.
+     */
+    void setTileMemoryLimit(qint64 bytes);
+    [[nodiscard]] qint64 tileMemoryLimit() const;
+
  protected:
     void resizeEvent(QResizeEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
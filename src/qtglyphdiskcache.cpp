@@ -0,0 +1,215 @@
+#include "qtglyphdiskcache_p.h"
+#include "qtglyphtable_p.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+#include <limits>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+static_assert(sizeof(QtGlyphDiskCache::Header_t) == 32, "unexpected size of QtGlyphDiskCache::Header_t");
+static_assert(sizeof(QtGlyphDiskCache::Record_t) == 40, "unexpected size of QtGlyphDiskCache::Record_t");
+
+static auto constexpr kPackSuffix = ".qifc";
+
+static quint32 StrideOf(int width) {
+    return (quint32(width) + 3) & ~quint32(3);
+}
+
+bool QtGlyphDiskCache::open(const QString &directory, const QString &source, quint64 content_hash) {
+    close();
+    if (directory.isEmpty()) return false;
+    if (!QDir().mkpath(directory)) {
+        qWarning("[QtIconFont] Cannot create cache directory: %s", qUtf8Printable(directory));
+        return false;
+    }
+    this->directory = directory;
+    this->prefix = QString::number(QtGlyphTable::hashKey(QStringView(source)), 16).rightJustified(8, '0') + '-';
+    this->replace_stale = !source.isEmpty();
+    this->content_hash = content_hash;
+    map();
+    return true;
+}
+
+void QtGlyphDiskCache::map() {
+    unmap();
+    QSharedPointer<QFile> file(new QFile(fileName()));
+    if (!file->exists()) return;
+    if (!file->open(QIODevice::ReadOnly)) return;
+    auto size = file->size();
+    if (size <= 0 || size > std::numeric_limits<int>::max()) return;
+    auto mapped = file->map(0, size);
+    if (!mapped) return;
+    this->mapping = file;
+    this->data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), int(size));
+    QString error;
+    if (!attach(&error)) {
+        // a broken pack is replaced on save
+        qWarning("[QtIconFont] Cannot load cache file: %s, error: %s",
+                 qUtf8Printable(file->fileName()), qUtf8Printable(error));
+        unmap();
+    }
+}
+
+void QtGlyphDiskCache::unmap() {
+    this->records.clear();
+    this->data.clear();
+    this->mapping.reset();
+}
+
+bool QtGlyphDiskCache::attach(QString *error) {
+    auto size = quint64(this->data.size());
+    if (size < sizeof(Header_t)) {
+        *error = QStringLiteral("file is too small");
+        return false;
+    }
+    Header_t header{};
+    std::memcpy(&header, this->data.constData(), sizeof(Header_t));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        *error = QStringLiteral("bad magic");
+        return false;
+    }
+    if (header.version != kVersion || header.qt_version != QT_VERSION) {
+        *error = QStringLiteral("version mismatch");
+        return false;
+    }
+    if (header.content_hash != this->content_hash) {
+        *error = QStringLiteral("content hash mismatch");
+        return false;
+    }
+    if (header.index_offset > size || (size - header.index_offset) / sizeof(Record_t) < header.count) {
+        *error = QStringLiteral("index out of range");
+        return false;
+    }
+    this->records.reserve(int(header.count));
+    for (quint32 i = 0; i < header.count; ++i) {
+        Record_t record{};
+        std::memcpy(&record, this->data.constData() + header.index_offset + i * sizeof(Record_t), sizeof(Record_t));
+        auto bytes = quint64(record.stride) * record.height;
+        if (record.offset % 4 != 0 || record.stride < record.width || record.stride % 4 != 0
+            || record.offset > header.index_offset || bytes > header.index_offset - record.offset) {
+            *error = QStringLiteral("glyph %1 out of range").arg(i);
+            return false;
+        }
+        this->records.insert({record.codepoint, record.pixel_size, 0, record.dpr}, record);
+    }
+    return true;
+}
+
+void QtGlyphDiskCache::close() {
+    unmap();
+    this->pending.clear();
+    this->pending_bytes = 0;
+    this->directory.clear();
+    this->prefix.clear();
+    this->replace_stale = false;
+    this->content_hash = 0;
+    this->dirty = false;
+}
+
+QString QtGlyphDiskCache::fileName() const {
+    return QDir(this->directory).filePath(this->prefix + QString::number(this->content_hash, 16).rightJustified(16, '0')
+                                              + QLatin1String(kPackSuffix));
+}
+
+QImage QtGlyphDiskCache::find(const QtGlyphKey_t &key) {
+    if (!isOpen()) return {};
+    auto iter = this->records.constFind(key);
+    if (iter != this->records.constEnd()) {
+        auto const &record = iter.value();
+        // the read-only constructor wraps the mapping, nothing is copied
+        QImage image(reinterpret_cast<const uchar *>(this->data.constData() + record.offset),
+                     int(record.width), int(record.height), int(record.stride), QImage::Format_Alpha8);
+        image.setDevicePixelRatio(record.dpr);
+        ++this->hit_count;
+        return image;
+    }
+    auto pending_iter = this->pending.constFind(key);
+    if (pending_iter != this->pending.constEnd()) {
+        ++this->hit_count;
+        return pending_iter.value();
+    }
+    return {};
+}
+
+void QtGlyphDiskCache::insert(const QtGlyphKey_t &key, const QImage &mask) {
+    if (!isOpen() || mask.isNull() || mask.format() != QImage::Format_Alpha8) return;
+    if (this->records.contains(key)) return;
+    auto iter = this->pending.constFind(key);
+    if (iter != this->pending.constEnd()) this->pending_bytes -= iter.value().sizeInBytes();
+    this->pending.insert(key, mask);
+    this->pending_bytes += mask.sizeInBytes();
+    this->dirty = true;
+}
+
+bool QtGlyphDiskCache::save() {
+    if (!isOpen() || !this->dirty) return true;
+    QSaveFile file(fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("[QtIconFont] Cannot write cache file: %s", qUtf8Printable(file.fileName()));
+        return false;
+    }
+    QVector<Record_t> index;
+    index.reserve(this->records.size() + this->pending.size());
+    // the header is written last, when the index offset is known
+    Header_t header{};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    quint64 offset = sizeof(Header_t);
+    static const char kPadding[4] = {0, 0, 0, 0};
+    // masks of the mapped pack are copied as they are
+    for (auto const &record : this->records) {
+        auto copy = record;
+        copy.offset = offset;
+        file.write(this->data.constData() + record.offset, qint64(record.stride) * record.height);
+        offset += quint64(record.stride) * record.height;
+        index.append(copy);
+    }
+    for (auto iter = this->pending.cbegin(); iter != this->pending.cend(); ++iter) {
+        auto const &mask = iter.value();
+        Record_t record{iter.key().codepoint, iter.key().pixel_size, iter.key().dpr, offset,
+                        quint32(mask.width()), quint32(mask.height()), StrideOf(mask.width()), 0};
+        for (int y = 0; y < mask.height(); ++y) {
+            file.write(reinterpret_cast<const char *>(mask.constScanLine(y)), mask.width());
+            file.write(kPadding, record.stride - quint32(mask.width()));
+        }
+        offset += quint64(record.stride) * record.height;
+        index.append(record);
+    }
+    file.write(reinterpret_cast<const char *>(index.constData()), qint64(index.size()) * qint64(sizeof(Record_t)));
+
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.content_hash = this->content_hash;
+    header.count = quint32(index.size());
+    header.qt_version = QT_VERSION;
+    header.index_offset = offset;
+    file.seek(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    // a mapped file cannot be replaced on windows, the old pack is mapped again if the new one is not written
+    unmap();
+    if (!file.commit()) {
+        qWarning("[QtIconFont] Cannot write cache file: %s, error: %s",
+                 qUtf8Printable(file.fileName()), qUtf8Printable(file.errorString()));
+        map();
+        return false;
+    }
+    // later saves only rewrite the pack if more masks are rendered
+    this->dirty = false;
+    map();
+    // the saved masks are read from the new mapping, they are kept in memory only if it cannot be mapped
+    if (!this->records.isEmpty()) {
+        this->pending.clear();
+        this->pending_bytes = 0;
+    }
+
+    // packs of other content of the same source are stale
+    if (!this->replace_stale) return true;
+    auto current = QFileInfo(file.fileName()).fileName();
+    for (auto const &name : QDir(this->directory).entryList({this->prefix + '*' + QLatin1String(kPackSuffix)}, QDir::Files)) {
+        if (name != current) QFile::remove(QDir(this->directory).filePath(name));
+    }
+    return true;
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
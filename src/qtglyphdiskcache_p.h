@@ -0,0 +1,103 @@
+#ifndef QTWIDGETS_SRC_QTGLYPHDISKCACHE_P_H_
+#define QTWIDGETS_SRC_QTGLYPHDISKCACHE_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include "qtglyphkey_p.h"
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QSharedPointer>
+#include <QString>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief persistent cache of glyph alpha masks, one memory-mapped pack file per font.
+ *
+ * the pack is named after the source of the font and the content hash of the font and the manifest,
+ * so a pack is never used for other bytes, and stale packs of the same source are removed on save:
+ * <pre>
+ * Header_t | alpha8 pixels of each glyph, rows padded to 4 bytes | Record_t[count]
+ * </pre>
+ * values are in native byte order, it is a local cache. masks are used in place in the mapping.
+ * the pack is unmapped while it is replaced on save, since a mapped file cannot be replaced on windows.
+ */
+class QtGlyphDiskCache {
+ public:
+    struct Header_t {
+        char magic[4];
+        quint32 version;
+        quint64 content_hash;
+        quint32 count;
+        quint32 qt_version; // the rasterizer may change between qt versions
+        quint64 index_offset;
+    };
+    struct Record_t {
+        quint32 codepoint;
+        qint32 pixel_size;
+        double dpr;
+        quint64 offset;
+        quint32 width;
+        quint32 height;
+        quint32 stride;
+        quint32 reserved;
+    };
+    static constexpr char kMagic[4] = {'Q', 'I', 'F', 'C'};
+    static constexpr quint32 kVersion = 1;
+    // new masks beyond it should be saved, so they are not all kept in memory until exit
+    static constexpr qint64 kPendingLimit = 4 * 1024 * 1024;
+
+ public:
+    /**
+     * @brief map the pack of the font in the directory if it exists, new masks are kept until save
+     * @param [in] directory cache directory, it is created if needed
+     * @param [in] source where the font is loaded from, packs of other content of the source are replaced on save.
+     *                    fonts of the same name may come from different files, so the name alone is not enough.
+     *                    if it is empty, no pack is replaced
+     * @param [in] content_hash hash of the font and the manifest bytes
+     */
+    bool open(const QString &directory, const QString &source, quint64 content_hash);
+    void close();
+    [[nodiscard]] bool isOpen() const { return !this->directory.isEmpty(); }
+    [[nodiscard]] QString path() const { return this->directory; }
+    /**
+     * @brief find a mask, the returned image wraps the mapping and is valid until close or save
+     */
+    [[nodiscard]] QImage find(const QtGlyphKey_t &key);
+    void insert(const QtGlyphKey_t &key, const QImage &mask);
+    /**
+     * @brief write the mapped and the new masks to the pack and map it again, nothing is written
+     *        if there are no new masks. images returned by find must be released before
+     */
+    bool save();
+    [[nodiscard]] qint64 hits() const { return this->hit_count; }
+    // bytes of the masks which are not saved
+    [[nodiscard]] qint64 pendingBytes() const { return this->pending_bytes; }
+
+ private:
+    [[nodiscard]] QString fileName() const;
+    // map the pack of the content if it exists, records are empty if it cannot be mapped
+    void map();
+    void unmap();
+    bool attach(QString *error);
+
+ private:
+    QString directory;
+    QString prefix; // file name prefix of packs of the source
+    bool replace_stale = false; // the source is known
+    quint64 content_hash = 0;
+    QSharedPointer<QFile> mapping;
+    QByteArray data; // wraps mapping
+    QHash<QtGlyphKey_t, Record_t> records; // masks in the mapping
+    QHash<QtGlyphKey_t, QImage> pending; // masks rendered since the pack is mapped
+    bool dirty = false; // pending has masks which are not saved
+    qint64 pending_bytes = 0; // bytes of the masks which are not saved
+    qint64 hit_count = 0;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTGLYPHDISKCACHE_P_H_
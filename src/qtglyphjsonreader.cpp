@@ -0,0 +1,355 @@
+#include "qtglyphjsonreader_p.h"
+#include <QByteArray>
+#include <cmath>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+static auto constexpr kMaxDepth = 512;
+
+static bool IsDigit(char ch) {
+    return ch >= '0' && ch <= '9';
+}
+
+static int HexValue(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+QtGlyphJsonReader::QtGlyphJsonReader(const char *data, qint64 size, QtGlyphTable *table)
+    : begin(data), pos(data), end(data + size), table(table) {
+}
+
+bool QtGlyphJsonReader::read() {
+    // skip utf-8 bom
+    if (this->end - this->pos >= 3 && QByteArray::fromRawData(this->pos, 3) == "\xEF\xBB\xBF") {
+        this->pos += 3;
+    }
+    if (!readRoot()) return false;
+    skipWhitespace();
+    if (!atEnd()) return fail("garbage at the end of the document");
+    return true;
+}
+
+bool QtGlyphJsonReader::readRoot() {
+    QString font_name, description;
+    skipWhitespace();
+    if (peek() != '{') return fail("document is not an object");
+    ++this->pos;
+    skipWhitespace();
+    if (peek() == '}') {
+        ++this->pos;
+    } else {
+        while (true) {
+            skipWhitespace();
+            if (peek() != '"') return fail("object key expected");
+            if (!readString(&this->key)) return false;
+            if (!expect(':')) return false;
+            skipWhitespace();
+            // the last of repeated keys wins, same as QJsonDocument, a value of a wrong type clears the field
+            bool ok;
+            if (this->key == QLatin1String("name")) {
+                font_name.clear();
+                ok = peek() == '"' ? readString(&font_name) : skipValue(1);
+            } else if (this->key == QLatin1String("description")) {
+                description.clear();
+                ok = peek() == '"' ? readString(&description) : skipValue(1);
+            } else if (this->key == QLatin1String("glyphs")) {
+                this->table->discardGlyphs();
+                ok = peek() == '[' ? readGlyphs() : skipValue(1);
+            } else {
+                ok = skipValue(1);
+            }
+            if (!ok) return false;
+            skipWhitespace();
+            if (peek() == ',') {
+                ++this->pos;
+                continue;
+            }
+            if (!expect('}')) return false;
+            break;
+        }
+    }
+    this->table->setMetadata(font_name, description);
+    this->table->build(QtGlyphTable::hashContent(this->begin, this->end - this->begin));
+    return true;
+}
+
+bool QtGlyphJsonReader::readGlyphs() {
+    ++this->pos; // '['
+    skipWhitespace();
+    if (peek() == ']') {
+        ++this->pos;
+        return true;
+    }
+    while (true) {
+        skipWhitespace();
+        // glyphs which are not objects are ignored, same as missing fields
+        bool ok = peek() == '{' ? readGlyph() : skipValue(2);
+        if (!ok) return false;
+        skipWhitespace();
+        if (peek() == ',') {
+            ++this->pos;
+            continue;
+        }
+        return expect(']');
+    }
+}
+
+bool QtGlyphJsonReader::readGlyph() {
+    static const QLatin1String kFieldNames[FieldCount] = {
+        QLatin1String("icon_id"),
+        QLatin1String("name"),
+        QLatin1String("font_class"),
+        QLatin1String("unicode"),
+        QLatin1String("unicode_decimal"),
+    };
+    int found = 0; // bit mask of GlyphField
+    double unicode_decimal = 0;
+
+    ++this->pos; // '{'
+    skipWhitespace();
+    if (peek() == '}') {
+        ++this->pos;
+        return true;
+    }
+    while (true) {
+        skipWhitespace();
+        if (peek() != '"') return fail("object key expected");
+        if (!readString(&this->key)) return false;
+        if (!expect(':')) return false;
+        skipWhitespace();
+        int field = 0;
+        while (field < FieldCount && this->key != kFieldNames[field]) ++field;
+        bool ok;
+        if (field < FieldUnicodeDecimal && peek() == '"') {
+            ok = readString(&this->fields[field]);
+            found |= 1 << field;
+        } else if (field == FieldUnicodeDecimal && (peek() == '-' || IsDigit(peek()))) {
+            ok = readNumber(&unicode_decimal);
+            found |= 1 << field;
+        } else {
+            // unknown field, or a known field of a wrong type which makes the glyph invalid
+            if (field < FieldCount) found &= ~(1 << field);
+            ok = skipValue(3);
+        }
+        if (!ok) return false;
+        skipWhitespace();
+        if (peek() == ',') {
+            ++this->pos;
+            continue;
+        }
+        if (!expect('}')) return false;
+        break;
+    }
+    if (found != (1 << FieldCount) - 1) return true;
+    // values which are not code points become 0, the range is checked first since converting a double
+    // out of the range of the integer is undefined
+    auto is_code_point = unicode_decimal >= 0 && unicode_decimal <= 0x10FFFF
+        && std::floor(unicode_decimal) == unicode_decimal;
+    auto code = is_code_point ? quint32(unicode_decimal) : 0u;
+    this->table->append(this->fields[FieldIconId], this->fields[FieldName], this->fields[FieldFontClass],
+                        this->fields[FieldUnicode], code);
+    return true;
+}
+
+bool QtGlyphJsonReader::readString(QString *out) {
+    ++this->pos; // '"'
+    if (out) out->truncate(0);
+    while (true) {
+        // copy runs of plain ascii at once
+        auto run = this->pos;
+        while (this->pos < this->end && uchar(*this->pos) >= 0x20 && uchar(*this->pos) < 0x80
+            && *this->pos != '"' && *this->pos != '\\') {
+            ++this->pos;
+        }
+        if (out && this->pos != run) out->append(QLatin1String(run, int(this->pos - run)));
+        if (atEnd()) return fail("unterminated string");
+
+        auto ch = uchar(*this->pos);
+        if (ch == '"') {
+            ++this->pos;
+            return true;
+        }
+        if (ch < 0x20) return fail("control character in string");
+        if (ch == '\\') {
+            if (this->end - this->pos < 2) return fail("unterminated string");
+            auto escape = this->pos[1];
+            this->pos += 2;
+            ushort unit;
+            switch (escape) {
+                case '"': unit = '"'; break;
+                case '\\': unit = '\\'; break;
+                case '/': unit = '/'; break;
+                case 'b': unit = '\b'; break;
+                case 'f': unit = '\f'; break;
+                case 'n': unit = '\n'; break;
+                case 'r': unit = '\r'; break;
+                case 't': unit = '\t'; break;
+                case 'u': {
+                    if (this->end - this->pos < 4) return fail("invalid unicode escape");
+                    unit = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        auto value = HexValue(this->pos[i]);
+                        if (value < 0) return fail("invalid unicode escape");
+                        unit = ushort(unit << 4 | value);
+                    }
+                    // surrogate pairs are written as two escapes, each of them is one utf-16 code unit
+                    this->pos += 4;
+                    break;
+                }
+                default:
+                    this->pos -= 1;
+                    return fail("invalid escape sequence");
+            }
+            if (out) out->append(QChar(unit));
+            continue;
+        }
+        // multi-byte utf-8 sequence
+        int extra;
+        uint code;
+        if ((ch & 0xE0) == 0xC0) {
+            extra = 1;
+            code = ch & 0x1F;
+        } else if ((ch & 0xF0) == 0xE0) {
+            extra = 2;
+            code = ch & 0x0F;
+        } else if ((ch & 0xF8) == 0xF0) {
+            extra = 3;
+            code = ch & 0x07;
+        } else {
+            return fail("invalid utf-8 sequence");
+        }
+        if (this->end - this->pos <= extra) return fail("invalid utf-8 sequence");
+        for (int i = 1; i <= extra; ++i) {
+            auto next = uchar(this->pos[i]);
+            if ((next & 0xC0) != 0x80) return fail("invalid utf-8 sequence");
+            code = code << 6 | (next & 0x3F);
+        }
+        static const uint kMinCode[] = {0, 0x80, 0x800, 0x10000};
+        if (code < kMinCode[extra] || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+            return fail("invalid utf-8 sequence");
+        }
+        this->pos += extra + 1;
+        if (!out) continue;
+        if (QChar::requiresSurrogates(code)) {
+            out->append(QChar(QChar::highSurrogate(code)));
+            out->append(QChar(QChar::lowSurrogate(code)));
+        } else {
+            out->append(QChar(ushort(code)));
+        }
+    }
+}
+
+bool QtGlyphJsonReader::readNumber(double *out) {
+    auto start = this->pos;
+    bool integral = true;
+    if (peek() == '-') ++this->pos;
+    if (peek() == '0') {
+        ++this->pos;
+    } else if (IsDigit(peek())) {
+        while (IsDigit(peek())) ++this->pos;
+    } else {
+        return fail("invalid number");
+    }
+    if (peek() == '.') {
+        integral = false;
+        ++this->pos;
+        if (!IsDigit(peek())) return fail("invalid number");
+        while (IsDigit(peek())) ++this->pos;
+    }
+    if (peek() == 'e' || peek() == 'E') {
+        integral = false;
+        ++this->pos;
+        if (peek() == '+' || peek() == '-') ++this->pos;
+        if (!IsDigit(peek())) return fail("invalid number");
+        while (IsDigit(peek())) ++this->pos;
+    }
+    if (!out) return true;
+    auto length = this->pos - start;
+    if (integral && length <= 18) {
+        // fast path for code points, it is exact
+        qint64 value = 0;
+        auto digit = start + (*start == '-' ? 1 : 0);
+        for (; digit < this->pos; ++digit) value = value * 10 + (*digit - '0');
+        *out = double(*start == '-' ? -value : value);
+        return true;
+    }
+    // toDouble always uses the C locale
+    *out = QByteArray::fromRawData(start, int(length)).toDouble();
+    return true;
+}
+
+bool QtGlyphJsonReader::skipValue(int depth) {
+    if (depth > kMaxDepth) return fail("document is too deep");
+    skipWhitespace();
+    switch (peek()) {
+        case '"':
+            return readString(nullptr);
+        case '{':
+        case '[': {
+            auto close = *this->pos == '{' ? '}' : ']';
+            ++this->pos;
+            skipWhitespace();
+            if (peek() == close) {
+                ++this->pos;
+                return true;
+            }
+            while (true) {
+                skipWhitespace();
+                if (close == '}') {
+                    if (peek() != '"') return fail("object key expected");
+                    if (!readString(nullptr)) return false;
+                    if (!expect(':')) return false;
+                }
+                if (!skipValue(depth + 1)) return false;
+                skipWhitespace();
+                if (peek() == ',') {
+                    ++this->pos;
+                    continue;
+                }
+                return expect(close);
+            }
+        }
+        case 't':
+        case 'f':
+        case 'n': {
+            auto literal = peek() == 't' ? QByteArray("true") : peek() == 'f' ? QByteArray("false") : QByteArray("null");
+            if (this->end - this->pos < literal.size()
+                || QByteArray::fromRawData(this->pos, literal.size()) != literal) {
+                return fail("invalid literal");
+            }
+            this->pos += literal.size();
+            return true;
+        }
+        default:
+            if (peek() == '-' || IsDigit(peek())) return readNumber(nullptr);
+            return fail(atEnd() ? "unexpected end of document" : "unexpected character");
+    }
+}
+
+bool QtGlyphJsonReader::expect(char ch) {
+    skipWhitespace();
+    if (peek() != ch) {
+        return fail(atEnd() ? QString("unexpected end of document, expect '%1'").arg(ch)
+                            : QString("expect '%1'").arg(ch));
+    }
+    ++this->pos;
+    return true;
+}
+
+void QtGlyphJsonReader::skipWhitespace() {
+    while (this->pos < this->end
+        && (*this->pos == ' ' || *this->pos == '\n' || *this->pos == '\r' || *this->pos == '\t')) {
+        ++this->pos;
+    }
+}
+
+bool QtGlyphJsonReader::fail(const QString &message) {
+    this->error_offset = this->pos - this->begin;
+    this->error_string = message;
+    return false;
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
@@ -0,0 +1,71 @@
+#ifndef QTWIDGETS_SRC_QTGLYPHJSONREADER_P_H_
+#define QTWIDGETS_SRC_QTGLYPHJSONREADER_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include "qtglyphtable_p.h"
+#include <QString>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief streaming reader of the iconfont.cn json layout.
+ *
+ * it walks the json text once and only keeps "name", "description" and the five fields of each glyph,
+ * which are appended to the glyph table directly. everything else is validated and skipped,
+ * so no document tree is built and the memory used is proportional to the glyph table.
+ */
+class QtGlyphJsonReader {
+ public:
+    QtGlyphJsonReader(const char *data, qint64 size, QtGlyphTable *table);
+
+ public:
+    /**
+     * @brief read the json and build the table
+     * @return false if the json is malformed, see errorOffset and errorString
+     */
+    bool read();
+    /**
+     * @brief byte offset in the json data where the error occurs
+     */
+    [[nodiscard]] qint64 errorOffset() const { return this->error_offset; }
+    [[nodiscard]] QString errorString() const { return this->error_string; }
+
+ private:
+    enum GlyphField {
+        FieldIconId = 0,
+        FieldName,
+        FieldFontClass,
+        FieldUnicode,
+        FieldUnicodeDecimal,
+        FieldCount,
+    };
+
+ private:
+    bool readRoot();
+    bool readGlyphs();
+    bool readGlyph();
+    bool readString(QString *out);
+    bool readNumber(double *out);
+    bool skipValue(int depth);
+    bool expect(char ch);
+    void skipWhitespace();
+    [[nodiscard]] bool atEnd() const { return this->pos >= this->end; }
+    [[nodiscard]] char peek() const { return atEnd() ? '\0' : *this->pos; }
+    bool fail(const QString &message);
+
+ private:
+    const char *begin, *pos, *end;
+    QtGlyphTable *table;
+    qint64 error_offset = -1;
+    QString error_string;
+
+    // scratch buffers, reused for every glyph
+    QString key;
+    QString fields[FieldUnicodeDecimal];
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTGLYPHJSONREADER_P_H_
@@ -0,0 +1,34 @@
+#ifndef QTWIDGETS_SRC_QTGLYPHKEY_P_H_
+#define QTWIDGETS_SRC_QTGLYPHKEY_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include <QHash>
+#include <QRgb>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief key of a rasterized glyph
+ */
+struct QtGlyphKey_t {
+    uint32_t codepoint = 0;
+    int pixel_size = 0;
+    QRgb color = 0;
+    qreal dpr = 1.0;
+};
+
+inline bool operator==(const QtGlyphKey_t &a, const QtGlyphKey_t &b) {
+    return a.codepoint == b.codepoint && a.pixel_size == b.pixel_size
+        && a.color == b.color && a.dpr == b.dpr;
+}
+
+inline uint qHash(const QtGlyphKey_t &key, uint seed = 0) {
+    return ::qHash((quint64(key.codepoint) << 32) | quint32(key.pixel_size), seed)
+        ^ ::qHash(key.color, seed) ^ ::qHash(key.dpr, seed);
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTGLYPHKEY_P_H_
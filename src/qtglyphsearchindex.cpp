@@ -0,0 +1,61 @@
+#include "qtglyphsearchindex_p.h"
+#include <algorithm>
+#include <numeric>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+static auto constexpr kExactScore = 1000;
+static auto constexpr kPrefixScore = 800;
+static auto constexpr kSubstringScore = 600;
+static auto constexpr kFuzzyScore = 300;
+static auto constexpr kMaxFuzzyScore = 499; // fuzzy matches always rank below substrings
+
+static bool IsBoundary(QStringView text, int i) {
+    return i == 0 || !text[i - 1].isLetterOrNumber();
+}
+
+QtGlyphSearchIndex::QtGlyphSearchIndex(const QtGlyphTable &table) {
+    this->keys.reserve(table.size() * 2);
+    for (int i = 0; i < table.size(); ++i) {
+        auto const &record = table.record(i);
+        this->keys.append(table.string(record.font_class).toString().toCaseFolded());
+        this->keys.append(table.string(record.name).toString().toCaseFolded());
+    }
+    this->sorted.resize(this->keys.size());
+    std::iota(this->sorted.begin(), this->sorted.end(), 0);
+    std::sort(this->sorted.begin(), this->sorted.end(), [this](int a, int b) { return this->keys[a] < this->keys[b]; });
+}
+
+QVector<int> QtGlyphSearchIndex::prefixEntries(QStringView prefix) const {
+    auto first = std::lower_bound(this->sorted.begin(), this->sorted.end(), prefix, [this](int entry, QStringView key) {
+        return QStringView(this->keys[entry]).compare(key) < 0;
+    });
+    QVector<int> entries;
+    for (auto it = first; it != this->sorted.end() && QStringView(this->keys[*it]).startsWith(prefix); ++it) {
+        entries.append(*it);
+    }
+    return entries;
+}
+
+int QtGlyphSearchIndex::score(int entry, QStringView query) const {
+    QStringView text(this->keys[entry]);
+    if (query.isEmpty() || query.size() > text.size()) return 0;
+    if (text == query) return kExactScore;
+    if (text.startsWith(query)) return kPrefixScore - int(qMin<qsizetype>(100, text.size() - query.size()));
+    auto pos = int(text.indexOf(query));
+    if (pos >= 0) return kSubstringScore + (IsBoundary(text, pos) ? 100 : 0) - qMin(100, pos);
+
+    // greedy subsequence, consecutive and word boundary characters score higher, gaps score lower
+    int score = kFuzzyScore, matched = 0, last = -1;
+    for (int i = 0; i < text.size() && matched < query.size(); ++i) {
+        if (text[i] != query[matched]) continue;
+        if (last >= 0) score += i == last + 1 ? 8 : -qMin(i - last - 1, 10);
+        if (IsBoundary(text, i)) score += 10;
+        last = i;
+        ++matched;
+    }
+    if (matched < query.size()) return 0;
+    return qBound(1, score, kMaxFuzzyScore);
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
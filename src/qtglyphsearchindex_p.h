@@ -0,0 +1,47 @@
+#ifndef QTWIDGETS_SRC_QTGLYPHSEARCHINDEX_P_H_
+#define QTWIDGETS_SRC_QTGLYPHSEARCHINDEX_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include "qtglyphtable_p.h"
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief search index over class names and names of glyphs.
+ *
+ * every glyph has two entries, entry 2 * i is the case folded class name of glyph i and entry 2 * i + 1 is its name.
+ * entries are also kept in sorted order, so prefix lookups are binary searches. it is immutable once built.
+ */
+class QtGlyphSearchIndex {
+ public:
+    explicit QtGlyphSearchIndex(const QtGlyphTable &table);
+
+ public:
+    [[nodiscard]] int entryCount() const { return this->keys.size(); }
+    [[nodiscard]] static int glyphOf(int entry) { return entry / 2; }
+    [[nodiscard]] const QString &key(int entry) const { return this->keys[entry]; }
+    /**
+     * @brief get entries starting with the prefix, in sorted order
+     * @param [in] prefix case folded prefix
+     */
+    [[nodiscard]] QVector<int> prefixEntries(QStringView prefix) const;
+    /**
+     * @brief score how well the entry matches the query, exact > prefix > substring > fuzzy subsequence
+     * @param [in] query case folded query
+     * @return 0 if not matched. any entry matching a query also matches all prefixes of the query.
+     */
+    [[nodiscard]] int score(int entry, QStringView query) const;
+
+ private:
+    QVector<QString> keys;
+    QVector<int> sorted; // entries sorted by key
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTGLYPHSEARCHINDEX_P_H_
@@ -0,0 +1,335 @@
+#include "qtglyphtable_p.h"
+#include <QMutexLocker>
+#include <QSysInfo>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+static_assert(sizeof(QtGlyphTable::Header_t) == 64, "manifest header layout changed");
+static_assert(sizeof(QtGlyphTable::Record_t) == 36, "manifest record layout changed");
+
+static auto constexpr kFnvOffsetBasis = 2166136261u;
+static auto constexpr kFnvPrime = 16777619u;
+static auto constexpr kFnvOffsetBasis64 = 14695981039346656037ull;
+static auto constexpr kFnvPrime64 = 1099511628211ull;
+static auto constexpr kMinIndexCapacity = 8u;
+
+bool QtGlyphTable::keyEquals(QStringView a, QStringView b) {
+    return a == b;
+}
+
+bool QtGlyphTable::keyEquals(QStringView a, QLatin1String b) {
+    if (a.size() != b.size()) return false;
+    for (int i = 0; i < b.size(); ++i) {
+        if (a[i].unicode() != uchar(b.data()[i])) return false;
+    }
+    return true;
+}
+
+static quint32 Align4(quint32 value) {
+    return (value + 3) & ~3u;
+}
+
+quint32 QtGlyphTable::hashKey(QStringView key) {
+    // fnv-1a over utf-16 code units, stable across processes and qt versions, it is saved in manifests
+    quint32 hash = kFnvOffsetBasis;
+    for (auto ch : key) {
+        hash = (hash ^ ch.unicode()) * kFnvPrime;
+    }
+    return hash;
+}
+
+quint32 QtGlyphTable::hashKey(QLatin1String key) {
+    // must be the same as the utf-16 version for latin-1 characters
+    quint32 hash = kFnvOffsetBasis;
+    for (int i = 0; i < key.size(); ++i) {
+        hash = (hash ^ uchar(key.data()[i])) * kFnvPrime;
+    }
+    return hash;
+}
+
+quint64 QtGlyphTable::hashContent(const char *data, qint64 size) {
+    quint64 hash = kFnvOffsetBasis64;
+    for (qint64 i = 0; i < size; ++i) {
+        hash = (hash ^ uchar(data[i])) * kFnvPrime64;
+    }
+    return hash;
+}
+
+template<class Key>
+int QtGlyphTable::findKey(Index index, Key key) const {
+    auto index_slots = this->indexes[index];
+    if (!index_slots) return -1;
+    auto pos = hashKey(key) & this->index_mask;
+    // a manifest may have no empty slot, so the probe ends after one round at the latest
+    for (quint32 step = 0; step <= this->index_mask; ++step, pos = (pos + 1) & this->index_mask) {
+        auto slot = index_slots[pos];
+        if (slot == 0 || slot > quint32(this->count)) return -1;
+        auto i = int(slot - 1);
+        if (keyEquals(string(keyOf(index, this->records[i])), key)) return i;
+    }
+    return -1;
+}
+
+int QtGlyphTable::find(Index index, QStringView key) const {
+    return findKey(index, key);
+}
+
+int QtGlyphTable::find(Index index, QLatin1String key) const {
+    return findKey(index, key);
+}
+
+QStringView QtGlyphTable::string(const StringRef_t &ref) const {
+    return {this->pool + ref.offset, qsizetype(ref.length)};
+}
+
+const QtGlyphTable::FontInfo_t *QtGlyphTable::info(int i) const {
+    if (i < 0 || i >= this->count) return nullptr;
+    QMutexLocker locker(&this->info_mutex);
+    if (this->infos.isEmpty()) {
+        // sized once, so the returned pointers stay valid
+        this->infos.resize(this->count);
+        this->info_created.resize(this->count);
+    }
+    auto &info = this->infos[i];
+    if (!this->info_created.testBit(i)) {
+        auto const &record = this->records[i];
+        info.icon_id = string(record.icon_id).toString();
+        info.name = string(record.name).toString();
+        info.font_class = string(record.font_class).toString();
+        info.unicode = string(record.unicode).toString();
+        info.unicode_decimal = record.unicode_decimal;
+        this->info_created.setBit(i);
+    }
+    return &info;
+}
+
+QString QtGlyphTable::fontName() const {
+    return this->header ? string(this->header->font_name).toString() : QString();
+}
+
+QString QtGlyphTable::description() const {
+    return this->header ? string(this->header->description).toString() : QString();
+}
+
+quint64 QtGlyphTable::contentHash() const {
+    return this->header ? this->header->content_hash : 0;
+}
+
+bool QtGlyphTable::IsManifest(const QByteArray &head) {
+    return head.size() >= int(sizeof(kMagic)) && std::memcmp(head.constData(), kMagic, sizeof(kMagic)) == 0;
+}
+
+bool QtGlyphTable::load(const QByteArray &data, QString *error) {
+    this->blob = data;
+    this->mapped_file.reset();
+    return attach(this->blob.constData(), this->blob.size(), error);
+}
+
+bool QtGlyphTable::map(const QString &path, QString *error) {
+    QSharedPointer<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly)) {
+        *error = QString("Cannot open manifest file: %1").arg(path);
+        return false;
+    }
+    auto size = file->size();
+    auto mapped = file->map(0, size);
+    if (!mapped) {
+        *error = QString("Cannot map manifest file: %1").arg(path);
+        return false;
+    }
+    // the mapping lives until the file object is destroyed
+    this->blob.clear();
+    this->mapped_file.swap(file);
+    return attach(reinterpret_cast<const char *>(mapped), size, error);
+}
+
+bool QtGlyphTable::map(const QSharedPointer<QFile> &mapping, const QByteArray &data, QString *error) {
+    this->blob = data;
+    this->mapped_file = mapping;
+    return attach(this->blob.constData(), this->blob.size(), error);
+}
+
+QByteArray QtGlyphTable::manifest() const {
+    if (!this->data) return {};
+    return {this->data, int(this->data_size)};
+}
+
+bool QtGlyphTable::attach(const char *data, qint64 size, QString *error) {
+    this->data = nullptr;
+    this->data_size = 0;
+    this->header = nullptr;
+    this->records = nullptr;
+    std::fill(std::begin(this->indexes), std::end(this->indexes), nullptr);
+    this->pool = nullptr;
+    this->count = 0;
+    this->index_mask = 0;
+    {
+        QMutexLocker locker(&this->info_mutex);
+        this->infos.clear();
+        this->info_created.clear();
+    }
+
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian) {
+        *error = "Binary manifest is not supported on big-endian hosts";
+        return false;
+    }
+    if (size < qint64(sizeof(Header_t)) || (quintptr(data) & (alignof(Header_t) - 1)) != 0) {
+        *error = "Manifest is truncated";
+        return false;
+    }
+    auto header = reinterpret_cast<const Header_t *>(data);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        *error = "Not a binary manifest";
+        return false;
+    }
+    if (header->version != kVersion) {
+        *error = QString("Unsupported manifest version: %1").arg(header->version);
+        return false;
+    }
+    auto capacity = quint64(header->index_capacity);
+    auto records_end = quint64(header->records_offset) + quint64(header->glyph_count) * sizeof(Record_t);
+    auto indexes_end = quint64(header->indexes_offset) + capacity * IndexCount * sizeof(quint32);
+    auto pool_end = quint64(header->pool_offset) + quint64(header->pool_length) * sizeof(QChar);
+    bool valid = qint64(header->file_size) <= size
+        && capacity != 0 && (capacity & (capacity - 1)) == 0 && header->glyph_count < capacity
+        && header->records_offset >= sizeof(Header_t) && header->records_offset % 4 == 0
+        && header->indexes_offset % 4 == 0 && header->pool_offset % 2 == 0
+        && records_end <= header->file_size && indexes_end <= header->file_size && pool_end <= header->file_size;
+    if (!valid) {
+        *error = "Manifest is corrupted";
+        return false;
+    }
+    auto records = reinterpret_cast<const Record_t *>(data + header->records_offset);
+    auto in_pool = [header](const StringRef_t &ref) {
+        return quint64(ref.offset) + ref.length <= header->pool_length;
+    };
+    bool strings_valid = in_pool(header->font_name) && in_pool(header->description);
+    for (quint32 i = 0; strings_valid && i < header->glyph_count; ++i) {
+        auto const &record = records[i];
+        strings_valid = in_pool(record.icon_id) && in_pool(record.name)
+            && in_pool(record.font_class) && in_pool(record.unicode);
+    }
+    if (!strings_valid) {
+        *error = "Manifest is corrupted";
+        return false;
+    }
+
+    this->data = data;
+    this->data_size = header->file_size;
+    this->header = header;
+    this->records = records;
+    for (int index = 0; index < IndexCount; ++index) {
+        this->indexes[index] = reinterpret_cast<const quint32 *>(data + header->indexes_offset) + capacity * index;
+    }
+    this->pool = reinterpret_cast<const QChar *>(data + header->pool_offset);
+    this->count = int(header->glyph_count);
+    this->index_mask = quint32(capacity - 1);
+    return true;
+}
+
+void QtGlyphTable::reserve(int glyphs) {
+    this->pending_records.reserve(glyphs);
+    // class names and ids are usually short, it is only a hint
+    this->pending_pool.reserve(glyphs * 32);
+}
+
+void QtGlyphTable::setMetadata(QStringView font_name, QStringView description) {
+    this->pending_name = addString(font_name);
+    this->pending_description = addString(description);
+}
+
+void QtGlyphTable::append(QStringView icon_id, QStringView name, QStringView font_class,
+                          QStringView unicode, quint32 unicode_decimal) {
+    Record_t record{};
+    record.icon_id = addString(icon_id);
+    record.name = addString(name);
+    record.font_class = addString(font_class);
+    record.unicode = addString(unicode);
+    record.unicode_decimal = unicode_decimal;
+    this->pending_records.append(record);
+}
+
+void QtGlyphTable::discardGlyphs() {
+    // only glyph strings are in the pool before the metadata is set
+    this->pending_records.clear();
+    this->pending_pool.clear();
+}
+
+void QtGlyphTable::build(quint64 content_hash) {
+    auto glyph_count = quint32(this->pending_records.size());
+    auto capacity = kMinIndexCapacity;
+    while (capacity < glyph_count * 2) capacity <<= 1; // keep load factor below 0.5
+
+    Header_t header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.content_hash = content_hash;
+    header.glyph_count = glyph_count;
+    header.index_capacity = capacity;
+    header.records_offset = sizeof(Header_t);
+    header.indexes_offset = header.records_offset + glyph_count * quint32(sizeof(Record_t));
+    header.pool_offset = header.indexes_offset + capacity * IndexCount * quint32(sizeof(quint32));
+    header.pool_length = quint32(this->pending_pool.size());
+    header.file_size = Align4(header.pool_offset + header.pool_length * quint32(sizeof(QChar)));
+    header.font_name = this->pending_name;
+    header.description = this->pending_description;
+
+    QByteArray blob(int(header.file_size), '\0');
+    auto out = blob.data();
+    std::memcpy(out, &header, sizeof(header));
+    if (glyph_count > 0) {
+        std::memcpy(out + header.records_offset, this->pending_records.constData(), glyph_count * sizeof(Record_t));
+    }
+    if (header.pool_length > 0) {
+        std::memcpy(out + header.pool_offset, this->pending_pool.constData(), header.pool_length * sizeof(QChar));
+    }
+
+    auto all_slots = reinterpret_cast<quint32 *>(out + header.indexes_offset);
+    auto records = this->pending_records.constData();
+    auto pool = this->pending_pool.constData();
+    auto view = [pool](const StringRef_t &ref) { return QStringView(pool + ref.offset, qsizetype(ref.length)); };
+    for (int index = 0; index < IndexCount; ++index) {
+        auto index_slots = all_slots + capacity * quint32(index);
+        for (quint32 i = 0; i < glyph_count; ++i) {
+            auto key = view(keyOf(Index(index), records[i]));
+            for (auto pos = hashKey(key) & (capacity - 1);; pos = (pos + 1) & (capacity - 1)) {
+                auto &slot = index_slots[pos];
+                // the later glyph wins if the key is duplicated
+                if (slot == 0 || keyEquals(view(keyOf(Index(index), records[slot - 1])), key)) {
+                    slot = i + 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    this->pending_records = {};
+    this->pending_pool = {};
+    this->pending_name = {};
+    this->pending_description = {};
+    QString error;
+    load(blob, &error);
+}
+
+QtGlyphTable::StringRef_t QtGlyphTable::addString(QStringView str) {
+    StringRef_t ref{quint32(this->pending_pool.size()), quint32(str.size())};
+    this->pending_pool.append(str.data(), int(str.size()));
+    return ref;
+}
+
+QtGlyphTable::StringRef_t QtGlyphTable::keyOf(Index index, const Record_t &record) {
+    switch (index) {
+        case IconIdIndex:
+            return record.icon_id;
+        case NameIndex:
+            return record.name;
+        case FontClassIndex:
+        default:
+            return record.font_class;
+    }
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
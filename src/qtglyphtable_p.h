@@ -0,0 +1,169 @@
+#ifndef QTWIDGETS_SRC_QTGLYPHTABLE_P_H_
+#define QTWIDGETS_SRC_QTGLYPHTABLE_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include "qticonfont.h"
+#include <QBitArray>
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief flat glyph table, all strings of all glyphs share one string pool,
+ *        lookups go through open-addressing hash indexes and never allocate.
+ *
+ * the table lives in one blob which is exactly the binary manifest file:
+ * <pre>
+ * Header_t | Record_t[glyph_count] | quint32[index_capacity] x IndexCount | utf-16 string pool
+ * </pre>
+ * all values are little-endian and 4-byte aligned, so a mapped manifest is used in place.
+ */
+class QtGlyphTable {
+ public:
+    using FontInfo_t = QtIconFont::FontInfo_t;
+
+    struct StringRef_t {
+        quint32 offset; // offset in string pool, in utf-16 code units
+        quint32 length; // length in utf-16 code units
+    };
+    struct Record_t {
+        StringRef_t icon_id;
+        StringRef_t name;
+        StringRef_t font_class;
+        StringRef_t unicode;
+        quint32 unicode_decimal;
+    };
+    enum Index {
+        IconIdIndex = 0,
+        NameIndex,
+        FontClassIndex,
+        IndexCount,
+    };
+    struct Header_t {
+        char magic[4];
+        quint32 version;
+        quint64 content_hash; // hash of the source json
+        quint32 file_size;
+        quint32 glyph_count;
+        quint32 index_capacity; // power of two, slot value is glyph index + 1, 0 means empty
+        quint32 records_offset;
+        quint32 indexes_offset;
+        quint32 pool_offset;
+        quint32 pool_length; // in utf-16 code units
+        quint32 reserved;
+        StringRef_t font_name;
+        StringRef_t description;
+    };
+    static constexpr char kMagic[4] = {'Q', 'I', 'F', 'M'};
+    static constexpr quint32 kVersion = 1;
+
+ public:
+    QtGlyphTable() = default;
+    QtGlyphTable(const QtGlyphTable &) = delete;
+    QtGlyphTable &operator=(const QtGlyphTable &) = delete;
+
+ public: // ------ lookups
+    [[nodiscard]] int size() const { return this->count; }
+    /**
+     * @brief find glyph by key
+     * @return index of the glyph, or -1 if not found
+     */
+    [[nodiscard]] int find(Index index, QStringView key) const;
+    [[nodiscard]] int find(Index index, QLatin1String key) const;
+    [[nodiscard]] const Record_t &record(int i) const { return this->records[i]; }
+    [[nodiscard]] QStringView string(const StringRef_t &ref) const;
+    /**
+     * @brief get the glyph as FontInfo_t, it is created on first access and lives as long as the table
+     */
+    [[nodiscard]] const FontInfo_t *info(int i) const;
+    [[nodiscard]] QString fontName() const;
+    [[nodiscard]] QString description() const;
+    [[nodiscard]] quint64 contentHash() const;
+
+ public: // ------ manifest
+    /**
+     * @brief check whether the data starts like a binary manifest
+     */
+    static bool IsManifest(const QByteArray &head);
+    /**
+     * @brief use a binary manifest, the data is referenced, not copied
+     */
+    bool load(const QByteArray &data, QString *error);
+    /**
+     * @brief map a binary manifest file, the mapping lives as long as the table
+     */
+    bool map(const QString &path, QString *error);
+    /**
+     * @brief use a binary manifest which wraps a mapped file, the table keeps the mapping alive
+     */
+    bool map(const QSharedPointer<QFile> &mapping, const QByteArray &data, QString *error);
+    /**
+     * @brief get the binary manifest of the table
+     */
+    [[nodiscard]] QByteArray manifest() const;
+
+ public: // ------ building
+    void reserve(int glyphs);
+    void setMetadata(QStringView font_name, QStringView description);
+    void append(QStringView icon_id, QStringView name, QStringView font_class,
+                QStringView unicode, quint32 unicode_decimal);
+    /**
+     * @brief drop the appended glyphs, must be called before setMetadata
+     */
+    void discardGlyphs();
+    /**
+     * @brief build the table and hash indexes, must be called after all glyphs are appended
+     * @param [in] content_hash hash of the source data, it is saved in the manifest
+     */
+    void build(quint64 content_hash);
+
+ public:
+    static quint32 hashKey(QStringView key);
+    static quint32 hashKey(QLatin1String key);
+    static quint64 hashContent(const char *data, qint64 size);
+    static bool keyEquals(QStringView a, QStringView b);
+    static bool keyEquals(QStringView a, QLatin1String b);
+
+ private:
+    StringRef_t addString(QStringView str);
+    bool attach(const char *data, qint64 size, QString *error);
+    [[nodiscard]] static StringRef_t keyOf(Index index, const Record_t &record);
+    template<class Key>
+    [[nodiscard]] int findKey(Index index, Key key) const;
+
+ private:
+    // backing storage, either an owned/referenced blob or a mapped file
+    QByteArray blob;
+    QSharedPointer<QFile> mapped_file;
+    const char *data = nullptr;
+    qint64 data_size = 0;
+
+    // views into the backing storage
+    const Header_t *header = nullptr;
+    const Record_t *records = nullptr;
+    const quint32 *indexes[IndexCount] = {};
+    const QChar *pool = nullptr;
+    int count = 0;
+    quint32 index_mask = 0;
+
+    // building state, released by build()
+    QVector<Record_t> pending_records;
+    QString pending_pool;
+    StringRef_t pending_name{}, pending_description{};
+
+    mutable QMutex info_mutex;
+    mutable QVector<FontInfo_t> infos;
+    mutable QBitArray info_created;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTGLYPHTABLE_P_H_
@@ -1,79 +1,160 @@
 #include "qticonfont.h"
+#include "qticonfont_p.h"
+#include "qtglyphjsonreader_p.h"
+#include "qticonfontengine_p.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QFont>
 #include <QFontDatabase>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPointer>
+#include <QRawFont>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <algorithm>
+#include <limits>
 
 FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
 
 using FontInfo_t = QtIconFont::FontInfo_t;
 using FontInfoPtr_t = QtIconFont::FontInfoPtr_t;
 
-class QtIconFontPrivate {
- public:
-    QString font_name;
-    QString description;
-    QString font_family;
-    QString alias_name;
-    QMap<QString, FontInfoPtr_t> icon_id_map;
-    QMap<QString, FontInfoPtr_t> name_map;
-    QMap<QString, FontInfoPtr_t> font_class_map;
-
- public:
-    static QMap<QString, QtIconFont *> loaded_fonts;
-
- public:
-    static bool openFile(QFile *file);
-    static FontInfoPtr_t ReadFontInfo(const QJsonObject &obj);
-    bool parseJsonData(const QByteArray &data, const QString &file_name);
-    bool loadFontFromFile(QFile *font, QFile *json);
-};
-
-QMap<QString, QtIconFont *> QtIconFontPrivate::loaded_fonts;
+QtIconFontRegistry QtIconFontPrivate::loaded_fonts;
+QVector<QtIconFont *> QtIconFontPrivate::instances;
+QMutex QtIconFontData::shared_mutex;
+QHash<quint64, QWeakPointer<QtIconFontData>> QtIconFontData::shared_fonts;
 
 QtIconFont::QtIconFont(const QString &font, const QString &json, QObject *parent)
     : QObject(parent), d_ptr(new QtIconFontPrivate) {
     Q_D(QtIconFont);
-    auto font_file = new QFile(font);
-    auto json_file = new QFile(json);
-    if (!d->loadFontFromFile(font_file, json_file)) return;
-    d->alias_name = d->font_name;
-    QtIconFontPrivate::loaded_fonts.insert(d->alias_name, this);
+    QFile font_file(font);
+    QFile json_file(json);
+    auto data = QtIconFontData::Register(QtIconFontData::Load(&font_file, &json_file));
+    if (data) d->attach(this, data);
 }
 
 QtIconFont::QtIconFont(QFile *font, QFile *json, QObject *parent)
     : QObject(parent), d_ptr(new QtIconFontPrivate) {
     Q_D(QtIconFont);
-    if (!d->loadFontFromFile(font, json)) return;
-    d->alias_name = d->font_name;
-    QtIconFontPrivate::loaded_fonts.insert(d->alias_name, this);
+    auto data = QtIconFontData::Register(QtIconFontData::Load(font, json));
+    if (data) d->attach(this, data);
+}
+
+QtIconFont::QtIconFont(const QtIconFontDataPtr &data, QObject *parent)
+    : QObject(parent), d_ptr(new QtIconFontPrivate) {
+    Q_D(QtIconFont);
+    // data is loaded and registered already
+    d->attach(this, data);
 }
 
 QtIconFont::~QtIconFont() {
     Q_D(QtIconFont);
-    if (!d->font_family.isEmpty()) {
-        QtIconFontPrivate::loaded_fonts.remove(d->font_family);
-    }
+    if (this->isValid()) d->detach(this);
     delete d;
 }
 
+void QtIconFontPrivate::attach(QtIconFont *q, const QtIconFontDataPtr &loaded) {
+    this->data = loaded;
+    this->alias_name = loaded->font_name;
+    instances.append(q);
+    loaded_fonts.insert(this->alias_name, {q, loaded});
+}
+
+void QtIconFontPrivate::detach(QtIconFont *q) {
+    instances.removeOne(q);
+    releaseName(q);
+    // the data is shared by objects loaded from the same content, only the last one drops the caches.
+    // pixmaps must not be released in worker threads, which may still hold handles
+    auto shared = std::any_of(instances.cbegin(), instances.cend(), [this](QtIconFont *other) {
+        return other->d_func()->data == this->data;
+    });
+    if (!shared) {
+        this->data->saveDiskCache();
+        this->data->clearCache();
+    }
+}
+
+void QtIconFontPrivate::releaseName(QtIconFont *q) {
+    // the name may be taken over by another object already
+    if (loaded_fonts.value(this->alias_name).font != q) return;
+    // hand it over to another object of the same name, the latest one wins as when it is inserted
+    for (auto iter = instances.crbegin(); iter != instances.crend(); ++iter) {
+        auto *other = *iter;
+        if (other != q && other->d_func()->alias_name == this->alias_name) {
+            loaded_fonts.insert(this->alias_name, {other, other->d_func()->data});
+            return;
+        }
+    }
+    loaded_fonts.remove(this->alias_name);
+}
+
+/**
+ * @brief result of LoadAsync, the future is finished with nullptr when the last reference goes away
+ *        without a font, e.g. a queued registration is dropped because the application is destroyed
+ */
+class QtIconFontPromise {
+ public:
+    explicit QtIconFontPromise(const QFutureInterface<QtIconFont *> &promise) : promise(promise) {}
+    ~QtIconFontPromise() { finish(nullptr); }
+
+ public:
+    void finish(QtIconFont *font) {
+        if (this->finished) return;
+        this->finished = true;
+        this->promise.reportResult(font);
+        this->promise.reportFinished();
+    }
+
+ private:
+    QFutureInterface<QtIconFont *> promise;
+    bool finished = false;
+};
+
+QFuture<QtIconFont *> QtIconFont::LoadAsync(const QString &font, const QString &json, QObject *parent) {
+    QFutureInterface<QtIconFont *> promise;
+    promise.reportStarted();
+    auto future = promise.future();
+    QSharedPointer<QtIconFontPromise> delivery(new QtIconFontPromise(promise));
+    QPointer<QObject> owner(parent);
+    auto has_parent = parent != nullptr;
+    QtConcurrent::run([delivery, font, json, owner, has_parent] {
+        QFile font_file(font);
+        QFile json_file(json);
+        auto data = QtIconFontData::Load(&font_file, &json_file);
+        auto app = QCoreApplication::instance();
+        if (!data || !app) return;
+        // font database is only used in the gui thread
+        QMetaObject::invokeMethod(app, [delivery, data, owner, has_parent] {
+            // nobody would own the font
+            if (has_parent && !owner) return;
+            auto registered = QtIconFontData::Register(data);
+            delivery->finish(registered ? new QtIconFont(registered, owner.data()) : nullptr);
+        }, Qt::QueuedConnection);
+    });
+    return future;
+}
+
 bool QtIconFont::HasIconFont(const QString &font_name) {
     return QtIconFontPrivate::loaded_fonts.contains(font_name);
 }
 
 QtIconFont *QtIconFont::GetIconFont(const QString &font_name) {
-    return QtIconFontPrivate::loaded_fonts.value(font_name, nullptr);
+    return QtIconFontPrivate::loaded_fonts.value(font_name).font;
+}
+
+QtIconFontHandle QtIconFont::AcquireIconFont(const QString &font_name) {
+    return QtIconFontHandle(QtIconFontPrivate::loaded_fonts.value(font_name).data);
 }
 
 void QtIconFont::setAliasName(const QString &alias) {
     Q_D(QtIconFont);
-    auto iter = QtIconFontPrivate::loaded_fonts.find(d->alias_name);
-    if (iter != QtIconFontPrivate::loaded_fonts.end()) {
-        QtIconFontPrivate::loaded_fonts.erase(iter);
-    }
-    QtIconFontPrivate::loaded_fonts.insert(alias, this);
+    if (!this->isValid()) return;
+    d->releaseName(this);
+    d->alias_name = alias;
+    QtIconFontPrivate::loaded_fonts.insert(alias, {this, d->data});
 }
 
 QString QtIconFont::aliasName() const {
@@ -81,70 +162,514 @@ QString QtIconFont::aliasName() const {
     return d->alias_name;
 }
 
+QtIconFontHandle QtIconFont::handle() const {
+    Q_D(const QtIconFont);
+    if (!this->isValid()) return {};
+    return QtIconFontHandle(d->data);
+}
+
 bool QtIconFont::isValid() const {
     Q_D(const QtIconFont);
-    return !d->font_family.isEmpty();
+    return !d->data->font_family.isEmpty();
 }
 
 QString QtIconFont::fontName() const {
     Q_D(const QtIconFont);
-    return d->font_name;
+    return d->data->font_name;
+}
+
+QtIconFont::LoadTiming_t QtIconFont::loadTiming() const {
+    Q_D(const QtIconFont);
+    return d->data->load_timing;
 }
 
 QString QtIconFont::description() const {
     Q_D(const QtIconFont);
-    return d->description;
+    return d->data->description;
 }
 
 QString QtIconFont::fontFamily() const {
     Q_D(const QtIconFont);
-    return d->font_family;
+    return d->data->font_family;
 }
 
 QFont QtIconFont::font() const {
     Q_D(const QtIconFont);
-    return {d->font_family};
+    return {d->data->font_family};
 }
 
-template<class T>
-FontInfoPtr_t FindInfo(const QMap<T, FontInfoPtr_t> &map, const T &name) {
-    auto iter = map.find(name);
-    if (iter == map.end()) {
-        return nullptr;
-    }
-    return iter.value();
+template<class Key>
+FontInfoPtr_t FindInfo(const QSharedPointer<const QtIconFontData> &data, QtGlyphTable::Index index, Key key) {
+    return QtIconFontData::Info(data, data->glyphs.find(index, key));
 }
 
-template<class T>
-QChar FindIcon(const QMap<T, FontInfoPtr_t> &map, const T &name) {
-    auto iter = map.find(name);
-    if (iter == map.end()) {
+template<class Key>
+QChar FindIcon(const QtGlyphTable &table, QtGlyphTable::Index index, Key key) {
+    auto i = table.find(index, key);
+    if (i < 0) {
         return {};
     }
-    return {iter.value()->unicode_decimal};
+    return {table.record(i).unicode_decimal};
 }
 
 FontInfoPtr_t QtIconFont::fontInfoByClass(const QString &name) const {
+    return fontInfoByClass(QStringView(name));
+}
+
+FontInfoPtr_t QtIconFont::fontInfoByClass(QStringView name) const {
     Q_D(const QtIconFont);
-    return FindInfo(d->font_class_map, name);
+    return FindInfo(d->data, QtGlyphTable::FontClassIndex, name);
+}
+
+FontInfoPtr_t QtIconFont::fontInfoByClass(QLatin1String name) const {
+    Q_D(const QtIconFont);
+    return FindInfo(d->data, QtGlyphTable::FontClassIndex, name);
 }
 
 QChar QtIconFont::iconByClass(const QString &name) const {
+    return iconByClass(QStringView(name));
+}
+
+QChar QtIconFont::iconByClass(QStringView name) const {
     Q_D(const QtIconFont);
-    return FindIcon(d->font_class_map, name);
+    return FindIcon(d->data->glyphs, QtGlyphTable::FontClassIndex, name);
+}
+
+QChar QtIconFont::iconByClass(QLatin1String name) const {
+    Q_D(const QtIconFont);
+    return FindIcon(d->data->glyphs, QtGlyphTable::FontClassIndex, name);
 }
 
 FontInfoPtr_t QtIconFont::fontInfoById(const QString &id) const {
+    return fontInfoById(QStringView(id));
+}
+
+FontInfoPtr_t QtIconFont::fontInfoById(QStringView id) const {
+    Q_D(const QtIconFont);
+    return FindInfo(d->data, QtGlyphTable::IconIdIndex, id);
+}
+
+FontInfoPtr_t QtIconFont::fontInfoById(QLatin1String id) const {
     Q_D(const QtIconFont);
-    return FindInfo(d->icon_id_map, id);
+    return FindInfo(d->data, QtGlyphTable::IconIdIndex, id);
 }
 
 QChar QtIconFont::iconById(const QString &id) const {
+    return iconById(QStringView(id));
+}
+
+QChar QtIconFont::iconById(QStringView id) const {
+    Q_D(const QtIconFont);
+    return FindIcon(d->data->glyphs, QtGlyphTable::IconIdIndex, id);
+}
+
+QChar QtIconFont::iconById(QLatin1String id) const {
+    Q_D(const QtIconFont);
+    return FindIcon(d->data->glyphs, QtGlyphTable::IconIdIndex, id);
+}
+
+bool QtIconFontHandle::isValid() const {
+    return this->data && !this->data->font_family.isEmpty();
+}
+
+QString QtIconFontHandle::fontName() const {
+    return this->data ? this->data->font_name : QString();
+}
+
+QString QtIconFontHandle::fontFamily() const {
+    return this->data ? this->data->font_family : QString();
+}
+
+QFont QtIconFontHandle::font() const {
+    return {this->fontFamily()};
+}
+
+FontInfoPtr_t QtIconFontHandle::fontInfoByClass(QStringView name) const {
+    if (!this->data) return {};
+    return FindInfo(this->data, QtGlyphTable::FontClassIndex, name);
+}
+
+FontInfoPtr_t QtIconFontHandle::fontInfoByClass(QLatin1String name) const {
+    if (!this->data) return {};
+    return FindInfo(this->data, QtGlyphTable::FontClassIndex, name);
+}
+
+QChar QtIconFontHandle::iconByClass(QStringView name) const {
+    if (!this->data) return {};
+    return FindIcon(this->data->glyphs, QtGlyphTable::FontClassIndex, name);
+}
+
+QChar QtIconFontHandle::iconByClass(QLatin1String name) const {
+    if (!this->data) return {};
+    return FindIcon(this->data->glyphs, QtGlyphTable::FontClassIndex, name);
+}
+
+FontInfoPtr_t QtIconFontHandle::fontInfoById(QStringView id) const {
+    if (!this->data) return {};
+    return FindInfo(this->data, QtGlyphTable::IconIdIndex, id);
+}
+
+FontInfoPtr_t QtIconFontHandle::fontInfoById(QLatin1String id) const {
+    if (!this->data) return {};
+    return FindInfo(this->data, QtGlyphTable::IconIdIndex, id);
+}
+
+QChar QtIconFontHandle::iconById(QStringView id) const {
+    if (!this->data) return {};
+    return FindIcon(this->data->glyphs, QtGlyphTable::IconIdIndex, id);
+}
+
+QChar QtIconFontHandle::iconById(QLatin1String id) const {
+    if (!this->data) return {};
+    return FindIcon(this->data->glyphs, QtGlyphTable::IconIdIndex, id);
+}
+
+static bool ReadGlyphTable(const QString &json, QtGlyphTable *table) {
+    QFile json_file(json);
+    if (!QtIconFontData::openFile(&json_file)) return false;
+    QByteArray json_data;
+    auto mapping = QtIconFontData::mapFile(&json_file, &json_data);
+    if (!mapping) json_data = json_file.readAll();
+    return QtIconFontData::parseJsonData(json_data.constData(), json_data.size(), json, table);
+}
+
+static bool WriteManifest(const QtGlyphTable &table, const QString &manifest) {
+    auto data = table.manifest();
+    QSaveFile manifest_file(manifest);
+    if (!manifest_file.open(QIODevice::WriteOnly)
+        || manifest_file.write(data) != data.size() || !manifest_file.commit()) {
+        qWarning("[QtIconFont] Cannot write manifest file: %s", qUtf8Printable(manifest));
+        return false;
+    }
+    return true;
+}
+
+bool QtIconFont::CompileManifest(const QString &json, const QString &manifest) {
+    QtGlyphTable table;
+    if (!ReadGlyphTable(json, &table)) return false;
+    return WriteManifest(table, manifest);
+}
+
+bool QtIconFont::CompileManifest(const QString &json, const QString &manifest, const QStringList &font_classes) {
+    QtGlyphTable table;
+    if (!ReadGlyphTable(json, &table)) return false;
+    QtGlyphTable subset;
+    subset.reserve(font_classes.size());
+    subset.setMetadata(table.fontName(), table.description());
+    for (auto const &font_class : font_classes) {
+        auto i = table.find(QtGlyphTable::FontClassIndex, QStringView(font_class));
+        if (i < 0) {
+            qWarning("[QtIconFont] Glyph not found: %s in %s", qUtf8Printable(font_class), qUtf8Printable(json));
+            return false;
+        }
+        auto const &record = table.record(i);
+        subset.append(table.string(record.icon_id), table.string(record.name), table.string(record.font_class),
+                      table.string(record.unicode), record.unicode_decimal);
+    }
+    // the subset differs from the full manifest of the same json
+    auto classes = font_classes.join('\n').toUtf8();
+    subset.build(table.contentHash() ^ QtGlyphTable::hashContent(classes.constData(), classes.size()));
+    return WriteManifest(subset, manifest);
+}
+
+QPixmap QtIconFont::pixmap(const QString &name, int size, const QColor &color, qreal devicePixelRatio) const {
+    Q_D(const QtIconFont);
+    auto i = d->data->glyphs.find(QtGlyphTable::FontClassIndex, QStringView(name));
+    if (i < 0 || size <= 0 || devicePixelRatio <= 0) return {};
+    return d->data->glyphPixmap({d->data->glyphs.record(i).unicode_decimal, size, color.rgba(), devicePixelRatio});
+}
+
+QIcon QtIconFont::icon(const QString &name, const QColor &color) const {
+    IconColors_t colors;
+    colors.normal = color;
+    return icon(name, colors);
+}
+
+QIcon QtIconFont::icon(const QString &name, const IconColors_t &colors) const {
     Q_D(const QtIconFont);
-    return FindIcon(d->icon_id_map, id);
+    auto i = d->data->glyphs.find(QtGlyphTable::FontClassIndex, QStringView(name));
+    if (i < 0) return {};
+    return QIcon(new QtIconFontEngine(d->data, d->data->glyphs.record(i).unicode_decimal, name, colors));
 }
 
-bool QtIconFontPrivate::openFile(QFile *file) {
+QPainterPath QtIconFont::path(const QString &name) const {
+    Q_D(const QtIconFont);
+    auto i = d->data->glyphs.find(QtGlyphTable::FontClassIndex, QStringView(name));
+    if (i < 0) return {};
+    return d->data->glyphPath(d->data->glyphs.record(i).unicode_decimal);
+}
+
+QFuture<void> QtIconFont::preloadPaths() const {
+    Q_D(const QtIconFont);
+    QSharedPointer<const QtIconFontData> data = d->data;
+    return QtConcurrent::run([data] { data->preloadGlyphPaths(); });
+}
+
+QtIconFont::GlyphMetrics_t QtIconFont::glyphMetrics(const QString &name, qreal pixelSize) const {
+    Q_D(const QtIconFont);
+    auto i = d->data->glyphs.find(QtGlyphTable::FontClassIndex, QStringView(name));
+    if (i < 0 || pixelSize <= 0) return {};
+    auto table = d->data->glyphMetrics();
+    if (!table || table->units_per_em <= 0) return {};
+    auto scale = pixelSize / table->units_per_em;
+    auto const &glyph = table->glyphs[i];
+    GlyphMetrics_t metrics;
+    metrics.advance = glyph.advance * scale;
+    metrics.ascent = table->ascent * scale;
+    metrics.descent = table->descent * scale;
+    metrics.bounds = QRectF(0, -metrics.ascent, metrics.advance, metrics.ascent + metrics.descent);
+    metrics.ink = QRectF(glyph.ink.topLeft() * scale, glyph.ink.size() * scale);
+    return metrics;
+}
+
+void QtIconFont::setPixmapCacheLimit(qint64 bytes) {
+    Q_D(QtIconFont);
+    d->data->setCacheLimit(bytes);
+}
+
+qint64 QtIconFont::pixmapCacheLimit() const {
+    Q_D(const QtIconFont);
+    return d->data->cacheLimit();
+}
+
+QtIconFont::PixmapCacheStats_t QtIconFont::pixmapCacheStats() const {
+    Q_D(const QtIconFont);
+    return d->data->cacheStats();
+}
+
+void QtIconFont::clearPixmapCache() {
+    Q_D(QtIconFont);
+    d->data->clearCache();
+}
+
+bool QtIconFont::setDiskCacheDirectory(const QString &directory) {
+    Q_D(QtIconFont);
+    if (!isValid()) return false;
+    if (!d->data->openDiskCache(directory)) return false;
+    if (d->data->disk_cache.isOpen() && !d->save_disk_cache) {
+        auto data = d->data;
+        d->save_disk_cache = connect(qApp, &QCoreApplication::aboutToQuit, this, [data] {
+            data->saveDiskCache();
+        });
+    }
+    return true;
+}
+
+QString QtIconFont::diskCacheDirectory() const {
+    Q_D(const QtIconFont);
+    return d->data->disk_cache.path();
+}
+
+bool QtIconFont::saveDiskCache() {
+    Q_D(QtIconFont);
+    return d->data->saveDiskCache();
+}
+
+// multiply the four channels of a premultiplied pixel by alpha / 255, two channels at a time
+static inline quint32 ByteMul(quint32 pixel, quint32 alpha) {
+    auto rb = (pixel & 0xff00ff) * alpha;
+    rb = ((rb + ((rb >> 8) & 0xff00ff) + 0x800080) >> 8) & 0xff00ff;
+    auto ag = ((pixel >> 8) & 0xff00ff) * alpha;
+    ag = (ag + ((ag >> 8) & 0xff00ff) + 0x800080) & 0xff00ff00;
+    return ag | rb;
+}
+
+static QImage TintMask(const QImage &mask, QRgb color) {
+    QImage image(mask.size(), QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(mask.devicePixelRatio());
+    auto premultiplied = qPremultiply(color);
+    auto width = mask.width();
+    for (int y = 0; y < mask.height(); ++y) {
+        auto const *alpha = mask.constScanLine(y);
+        auto *pixels = reinterpret_cast<quint32 *>(image.scanLine(y));
+        // no branches and no lookups, compilers vectorize the loop
+        for (int x = 0; x < width; ++x) pixels[x] = ByteMul(premultiplied, alpha[x]);
+    }
+    return image;
+}
+
+QPixmap QtIconFontData::glyphPixmap(const QtGlyphKey_t &key) const {
+    auto cached = this->pixmap_cache.find(key);
+    if (!cached.isNull()) return cached;
+    auto mask_key = key;
+    mask_key.color = 0;
+    auto mask = this->mask_cache.find(mask_key);
+    if (mask.isNull()) {
+        mask = this->disk_cache.find(mask_key);
+        if (mask.isNull()) {
+            mask = renderMask(mask_key);
+            this->disk_cache.insert(mask_key, mask);
+            if (this->disk_cache.pendingBytes() >= QtGlyphDiskCache::kPendingLimit) saveDiskCache();
+        }
+        this->mask_cache.insert(mask_key, mask);
+    }
+    if (mask.isNull()) return {};
+    auto pixmap = QPixmap::fromImage(TintMask(mask, key.color));
+    pixmap.setDevicePixelRatio(key.dpr);
+    this->pixmap_cache.insert(key, pixmap);
+    return pixmap;
+}
+
+QImage QtIconFontData::renderMask(const QtGlyphKey_t &key) const {
+    QImage image(QSize(key.pixel_size, key.pixel_size) * key.dpr, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) return {};
+    image.setDevicePixelRatio(key.dpr);
+    image.fill(Qt::transparent);
+    QFont font(this->font_family);
+    font.setPixelSize(key.pixel_size);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    painter.drawText(QRect(0, 0, key.pixel_size, key.pixel_size), Qt::AlignCenter,
+                     QString::fromUcs4(&key.codepoint, 1));
+    painter.end();
+    // the alpha channel is the coverage of the glyph
+    auto mask = image.convertToFormat(QImage::Format_Alpha8);
+    mask.setDevicePixelRatio(key.dpr);
+    return mask;
+}
+
+void QtIconFontData::setCacheLimit(qint64 bytes) const {
+    bytes = std::max<qint64>(bytes, 0);
+    auto tinted = bytes / kTintedCacheShare;
+    this->pixmap_cache.setLimit(tinted);
+    this->mask_cache.setLimit(bytes - tinted);
+}
+
+qint64 QtIconFontData::cacheLimit() const {
+    return this->pixmap_cache.limit() + this->mask_cache.limit();
+}
+
+QtIconFont::PixmapCacheStats_t QtIconFontData::cacheStats() const {
+    auto tinted = this->pixmap_cache.stats();
+    auto masks = this->mask_cache.stats();
+    // every miss of the tinted cache looks up the mask cache, then the disk cache, the rest are rasterized
+    auto disk_hits = this->disk_cache.hits();
+    return {tinted.hits + masks.hits + disk_hits, masks.misses - disk_hits, tinted.evictions + masks.evictions,
+            tinted.bytes + masks.bytes, tinted.limit + masks.limit, tinted.count + masks.count};
+}
+
+void QtIconFontData::clearCache() const {
+    this->pixmap_cache.clear();
+    this->mask_cache.clear();
+}
+
+bool QtIconFontData::openDiskCache(const QString &directory) const {
+    saveDiskCache();
+    if (directory.isEmpty()) {
+        this->disk_cache.close();
+        return true;
+    }
+    // the pack is bound to the bytes of both the font and the manifest. it replaces the packs of earlier
+    // content of the same files, the font name is not used since unrelated fonts often share it
+    QString source;
+    if (!this->font_file_name.isEmpty() && !this->json_file_name.isEmpty()) {
+        source = QFileInfo(this->font_file_name).absoluteFilePath() + '\n'
+            + QFileInfo(this->json_file_name).absoluteFilePath();
+    }
+    return this->disk_cache.open(directory, source, this->content_hash);
+}
+
+bool QtIconFontData::saveDiskCache() const {
+    // cached masks may wrap the mapping of the pack, which is replaced if there are new masks
+    if (this->disk_cache.pendingBytes() > 0) this->mask_cache.clear();
+    return this->disk_cache.save();
+}
+
+QRawFont QtIconFontData::loadRawFont() const {
+    if (this->font_data.isEmpty()) return {};
+    QRawFont raw_font(this->font_data, 1, QFont::PreferNoHinting);
+    if (!raw_font.isValid()) return {};
+    // everything is extracted in font units, so no precision is lost by scaling
+    raw_font.setPixelSize(raw_font.unitsPerEm());
+    return raw_font;
+}
+
+QPainterPath QtIconFontData::extractPath(const QRawFont &raw_font, uint32_t codepoint) const {
+    QPainterPath path;
+    auto indexes = raw_font.glyphIndexesForString(QString::fromUcs4(&codepoint, 1));
+    if (indexes.size() == 1 && indexes.first() != 0) {
+        auto em = raw_font.unitsPerEm();
+        // points are scaled by 1/em after moving the baseline down by the ascent
+        QTransform transform;
+        transform.scale(1.0 / em, 1.0 / em);
+        transform.translate(0, raw_font.ascent());
+        path = transform.map(raw_font.pathForGlyph(indexes.first()));
+    }
+    return path;
+}
+
+QPainterPath QtIconFontData::glyphPath(uint32_t codepoint) const {
+    {
+        QMutexLocker locker(&this->outline_mutex);
+        auto iter = this->paths.constFind(codepoint);
+        if (iter != this->paths.constEnd()) return iter.value();
+    }
+    // the font is parsed without the lock, so other threads keep hitting the cache meanwhile.
+    // two threads may extract the same glyph, the first one inserted wins
+    auto raw_font = loadRawFont();
+    if (!raw_font.isValid()) return {};
+    // glyphs without an outline are cached too, so they are not extracted again
+    auto path = extractPath(raw_font, codepoint);
+    QMutexLocker locker(&this->outline_mutex);
+    auto iter = this->paths.constFind(codepoint);
+    if (iter != this->paths.constEnd()) return iter.value();
+    this->paths.insert(codepoint, path);
+    return path;
+}
+
+QSharedPointer<const QtGlyphMetricsTable_t> QtIconFontData::glyphMetrics() const {
+    {
+        QMutexLocker locker(&this->outline_mutex);
+        if (this->metrics) return this->metrics;
+    }
+    auto raw_font = loadRawFont();
+    if (!raw_font.isValid()) return {};
+    QSharedPointer<QtGlyphMetricsTable_t> table(new QtGlyphMetricsTable_t);
+    table->units_per_em = raw_font.unitsPerEm();
+    table->ascent = raw_font.ascent();
+    table->descent = raw_font.descent();
+    table->glyphs.resize(this->glyphs.size());
+    // one string of all glyphs, so the font engine is asked once for indexes and once for advances
+    QVector<uint> codepoints;
+    codepoints.reserve(this->glyphs.size());
+    for (int i = 0; i < this->glyphs.size(); ++i) codepoints.append(this->glyphs.record(i).unicode_decimal);
+    auto indexes = raw_font.glyphIndexesForString(QString::fromUcs4(codepoints.constData(), codepoints.size()));
+    if (indexes.size() == codepoints.size()) {
+        auto advances = raw_font.advancesForGlyphIndexes(indexes);
+        for (int i = 0; i < indexes.size(); ++i) {
+            if (indexes[i] == 0) continue;
+            table->glyphs[i] = {advances[i].x(), raw_font.boundingRect(indexes[i])};
+        }
+    } else {
+        // unpaired surrogates in the table, fall back to one glyph at a time
+        for (int i = 0; i < codepoints.size(); ++i) {
+            auto glyph = raw_font.glyphIndexesForString(QString::fromUcs4(&codepoints[i], 1));
+            if (glyph.size() != 1 || glyph.first() == 0) continue;
+            table->glyphs[i] = {raw_font.advancesForGlyphIndexes(glyph).first().x(),
+                                raw_font.boundingRect(glyph.first())};
+        }
+    }
+    QMutexLocker locker(&this->outline_mutex);
+    if (!this->metrics) this->metrics = table;
+    return this->metrics;
+}
+
+void QtIconFontData::preloadGlyphPaths() const {
+    // one raw font for the whole batch, it is created and destroyed in this thread
+    auto raw_font = loadRawFont();
+    if (!raw_font.isValid()) return;
+    for (int i = 0; i < this->glyphs.size(); ++i) {
+        auto codepoint = this->glyphs.record(i).unicode_decimal;
+        // the lock is taken per glyph, so lookups in the gui thread are not blocked until preloading completes
+        QMutexLocker locker(&this->outline_mutex);
+        if (this->paths.contains(codepoint)) continue;
+        this->paths.insert(codepoint, extractPath(raw_font, codepoint));
+    }
+}
+
+bool QtIconFontData::openFile(QFile *file) {
     if (!file->isOpen()) {
         if (!file->open(QIODevice::ReadOnly)) {
             qWarning("[QtIconFont] Cannot open font file: %s", qUtf8Printable(file->fileName()));
@@ -158,72 +683,180 @@ bool QtIconFontPrivate::openFile(QFile *file) {
     return true;
 }
 
-FontInfoPtr_t QtIconFontPrivate::ReadFontInfo(const QJsonObject &obj) {
-    auto icon_id = obj.value("icon_id");
-    auto name = obj.value("name");
-    auto font_class = obj.value("font_class");
-    auto unicode = obj.value("unicode");
-    auto unicode_decimal = obj.value("unicode_decimal");
-    if (!icon_id.isString()) return nullptr;
-    if (!name.isString()) return nullptr;
-    if (!font_class.isString()) return nullptr;
-    if (!unicode.isString()) return nullptr;
-    if (!unicode_decimal.isDouble()) return nullptr;
-    auto ptr = new QtIconFont::FontInfo_t;
-    ptr->icon_id = icon_id.toString();
-    ptr->name = name.toString();
-    ptr->font_class = font_class.toString();
-    ptr->unicode = unicode.toString();
-    ptr->unicode_decimal = unicode_decimal.toInt();
-    return QSharedPointer<FontInfo_t>(ptr);
-}
-
-bool QtIconFontPrivate::parseJsonData(const QByteArray &data, const QString &file_name) {
-    QJsonParseError err{};
-    auto doc = QJsonDocument::fromJson(data, &err);
-    if (err.error != QJsonParseError::NoError) {
-        qWarning("[QtIconFont] Cannot parse json file: %s, error: %s",
-                 qUtf8Printable(file_name), qUtf8Printable(err.errorString()));
-        return false;
+FontInfoPtr_t QtIconFontData::Info(const QSharedPointer<const QtIconFontData> &data, int i) {
+    auto info = data ? data->glyphs.info(i) : nullptr;
+    if (!info) return {};
+    // qt5 has no aliasing constructor, so the deleter holds the data instead of deleting the info
+    return FontInfoPtr_t(const_cast<FontInfo_t *>(info), [data](FontInfo_t *) {});
+}
+
+QSharedPointer<const QtGlyphSearchIndex> QtIconFontData::searchIndex() const {
+    QMutexLocker locker(&this->search_index_mutex);
+    if (!this->search_index) this->search_index.reset(new QtGlyphSearchIndex(this->glyphs));
+    return this->search_index;
+}
+
+QSharedPointer<QFile> QtIconFontData::mapFile(QFile *source, QByteArray *data) {
+    QSharedPointer<QFile> file(new QFile);
+    // a mapping is released with its file object, and callers often destroy theirs right after loading,
+    // so the open handle of the caller is mapped through a file object owned by the mapping.
+    // resource files have no handle, they are mapped by name and their data is never released
+    bool opened = false;
+    if (source->handle() != -1) {
+        opened = file->open(source->handle(), QIODevice::ReadOnly, QFileDevice::DontCloseHandle);
+    } else if (!source->fileName().isEmpty()) {
+        file->setFileName(source->fileName());
+        opened = file->open(QIODevice::ReadOnly);
     }
-    if (!doc.isObject()) {
-        qWarning("[QtIconFont] Json file is not a object: %s", qUtf8Printable(file_name));
+    if (!opened) return {};
+    auto size = file->size();
+    if (size <= 0 || size > std::numeric_limits<int>::max()) return {};
+    auto mapped = file->map(0, size);
+    if (!mapped) return {};
+    *data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), int(size));
+    return file;
+}
+
+bool QtIconFontData::parseJsonData(const char *data, qint64 size, const QString &file_name, QtGlyphTable *table) {
+    QtGlyphJsonReader reader(data, size, table);
+    if (!reader.read()) {
+        qWarning("[QtIconFont] Cannot parse json file: %s, error: %s at offset %lld",
+                 qUtf8Printable(file_name), qUtf8Printable(reader.errorString()), reader.errorOffset());
         return false;
     }
-    auto obj = doc.object();
-    auto glyphs = obj.value("glyphs").toArray();
-    this->font_name = obj.value("name").toString();
-    this->description = obj.value("description").toString();
-    for (auto &&item : glyphs) {
-        auto glyph = item.toObject();
-        auto ptr = ReadFontInfo(glyph);
-        if (!ptr) continue;
-        this->icon_id_map.insert(ptr->icon_id, ptr);
-        this->name_map.insert(ptr->name, ptr);
-        this->font_class_map.insert(ptr->font_class, ptr);
-    }
     return true;
 }
 
-bool QtIconFontPrivate::loadFontFromFile(QFile *font, QFile *json) {
+bool QtIconFontData::readFiles(QFile *font, QFile *json) {
+    QElapsedTimer timer;
+    timer.start();
     if (!openFile(font)) return false;
     if (!openFile(json)) return false;
     font->seek(0);
     json->seek(0);
-    auto font_data = font->readAll();
-    auto json_data = json->readAll();
+    // the font is read, not mapped. freetype faces keep a reference to the bytes they are created from, and
+    // they live in font caches, QFonts and icon engines beyond the font database entry, so the font database
+    // needs bytes it owns. they are shared with font_data for hashing and outlines
+    this->font_data = font->readAll();
+    this->font_file_name = font->fileName();
     font->close();
-    json->close();
 
-    if (!this->parseJsonData(json_data, json->fileName())) return false;
-    auto id = QFontDatabase::addApplicationFontFromData(font_data);
+    this->json_file_name = json->fileName();
+    quint64 glyphs_hash;
+    if (!QtGlyphTable::IsManifest(json->peek(sizeof(QtGlyphTable::kMagic)))) {
+        // kept until parsing, the table copies the strings it keeps
+        this->json_mapping = mapFile(json, &this->json_data);
+        if (!this->json_mapping) this->json_data = json->readAll();
+        this->json_pending = true;
+        json->close();
+        glyphs_hash = QtGlyphTable::hashContent(this->json_data.constData(), this->json_data.size());
+    } else {
+        // binary manifest, prefer mapping it over reading it. it is used in place, so there is nothing to parse
+        QString error;
+        QByteArray manifest;
+        auto mapping = mapFile(json, &manifest);
+        auto loaded = mapping ? this->glyphs.map(mapping, manifest, &error)
+                              : this->glyphs.load(json->readAll(), &error);
+        json->close();
+        if (!loaded) {
+            qWarning("[QtIconFont] Cannot load manifest file: %s, error: %s",
+                     qUtf8Printable(json->fileName()), qUtf8Printable(error));
+            return false;
+        }
+        glyphs_hash = this->glyphs.contentHash();
+    }
+    auto font_hash = QtGlyphTable::hashContent(this->font_data.constData(), this->font_data.size());
+    this->content_hash = font_hash ^ (glyphs_hash + 0x9e3779b97f4a7c15ULL + (font_hash << 6) + (font_hash >> 2));
+    this->load_timing.read_ns += timer.nsecsElapsed();
+    return true;
+}
+
+bool QtIconFontData::parseGlyphs() {
+    if (this->json_pending) {
+        QElapsedTimer timer;
+        timer.start();
+        auto parsed = parseJsonData(this->json_data.constData(), this->json_data.size(), this->json_file_name,
+                                    &this->glyphs);
+        this->json_data.clear();
+        this->json_mapping.reset();
+        this->json_pending = false;
+        this->load_timing.parse_ns += timer.nsecsElapsed();
+        if (!parsed) return false;
+    }
+    this->font_name = this->glyphs.fontName();
+    this->description = this->glyphs.description();
+    return true;
+}
+
+bool QtIconFontData::registerFont() {
+    QElapsedTimer timer;
+    timer.start();
+    auto id = QFontDatabase::addApplicationFontFromData(this->font_data);
     QStringList families = QFontDatabase::applicationFontFamilies(id);
+    this->load_timing.register_ns += timer.nsecsElapsed();
     if (families.empty()) {
-        qWarning("[QtIconFont] Cannot load font from file: %s", qUtf8Printable(font->fileName()));
+        qWarning("[QtIconFont] Cannot load font from file: %s", qUtf8Printable(this->font_file_name));
+        if (id != -1) QFontDatabase::removeApplicationFont(id);
         return false;
     }
+    this->font_id = id;
     this->font_family = families.first();
     return true;
 }
 
+QtIconFontDataPtr QtIconFontData::FindShared(quint64 content_hash) {
+    QMutexLocker locker(&shared_mutex);
+    return shared_fonts.value(content_hash).toStrongRef();
+}
+
+QtIconFontDataPtr QtIconFontData::Load(QFile *font, QFile *json, QtIconFont::LoadTiming_t *timing) {
+    auto data = Create();
+    auto read = data->readFiles(font, json);
+    if (timing) *timing = data->load_timing;
+    if (!read) return {};
+    // the same bytes are parsed and registered once
+    if (auto shared = FindShared(data->content_hash)) return shared;
+    auto parsed = data->parseGlyphs();
+    if (timing) *timing = data->load_timing;
+    if (!parsed) return {};
+    return data;
+}
+
+QtIconFontDataPtr QtIconFontData::Register(const QtIconFontDataPtr &data) {
+    if (!data) return {};
+    if (data->font_id != -1) return data;
+    // the same content may be loaded concurrently, the first registered one wins
+    if (auto shared = FindShared(data->content_hash)) return shared;
+    if (!data->registerFont()) return {};
+    QMutexLocker locker(&shared_mutex);
+    shared_fonts.insert(data->content_hash, data.toWeakRef());
+    return data;
+}
+
+QtIconFontDataPtr QtIconFontData::Create() {
+    return QtIconFontDataPtr(new QtIconFontData, &QtIconFontData::Destroy);
+}
+
+void QtIconFontData::Destroy(QtIconFontData *data) {
+    // pixmaps and the font database belong to the gui thread, so the whole data is destroyed there
+    auto app = QCoreApplication::instance();
+    if (!app || QThread::currentThread() == app->thread()) {
+        delete data;
+    } else {
+        QMetaObject::invokeMethod(app, [data] { delete data; }, Qt::QueuedConnection);
+    }
+}
+
+QtIconFontData::~QtIconFontData() {
+    if (this->font_id == -1) return;
+    {
+        QMutexLocker locker(&shared_mutex);
+        auto iter = shared_fonts.find(this->content_hash);
+        // the entry may belong to a font of the same content which is registered after this one died
+        if (iter != shared_fonts.end() && iter.value().isNull()) shared_fonts.erase(iter);
+    }
+    // it shares the font bytes, so fonts still referenced by QFonts or icon engines stay readable
+    if (QCoreApplication::instance()) QFontDatabase::removeApplicationFont(this->font_id);
+}
+
 FNRICE_QT_WIDGETS_END_NAMESPACE
@@ -0,0 +1,321 @@
+#ifndef QTWIDGETS_SRC_QTICONFONT_P_H_
+#define QTWIDGETS_SRC_QTICONFONT_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include "qticonfont.h"
+#include "qtglyphtable_p.h"
+#include "qtglyphkey_p.h"
+#include "qtglyphdiskcache_p.h"
+#include "qtglyphsearchindex_p.h"
+#include <QColor>
+#include <QAtomicInt>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QRawFont>
+#include <QRectF>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <list>
+
+static auto constexpr kDefaultPixmapCacheLimit = 10 * 1024 * 1024; // same as QPixmapCache
+static auto constexpr kTintedCacheShare = 4; // tinted glyphs get 1/4 of the budget, alpha masks the rest
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief metrics of all glyphs of a font in font units, rows are in the order of the glyph table
+ */
+struct QtGlyphMetricsTable_t {
+    struct Glyph_t {
+        qreal advance = 0;
+        QRectF ink; // relative to the origin on the baseline
+    };
+    qreal units_per_em = 0;
+    qreal ascent = 0;
+    qreal descent = 0;
+    QVector<Glyph_t> glyphs;
+};
+
+/**
+ * @brief lru cache of rasterized glyphs, the cost of an entry is its byte size.
+ *        Value is QImage for alpha masks or QPixmap for tinted glyphs.
+ */
+template<class Value>
+class QtGlyphCache {
+ public:
+    using Stats_t = QtIconFont::PixmapCacheStats_t;
+
+ public:
+    [[nodiscard]] Value find(const QtGlyphKey_t &key) {
+        auto iter = this->entries.find(key);
+        if (iter == this->entries.end()) {
+            ++this->misses;
+            return {};
+        }
+        ++this->hits;
+        // move to the front of the lru list, iterators stay valid
+        this->lru.splice(this->lru.begin(), this->lru, iter.value());
+        return iter.value()->value;
+    }
+    void insert(const QtGlyphKey_t &key, const Value &value) {
+        auto cost = costOf(value);
+        if (value.isNull() || cost > this->limit_bytes) return;
+        auto iter = this->entries.find(key);
+        if (iter != this->entries.end()) {
+            this->total_bytes -= iter.value()->cost;
+            this->lru.erase(iter.value());
+            this->entries.erase(iter);
+        }
+        trim(this->limit_bytes - cost);
+        this->lru.push_front({key, value, cost});
+        this->entries.insert(key, this->lru.begin());
+        this->total_bytes += cost;
+    }
+    void setLimit(qint64 bytes) {
+        this->limit_bytes = std::max<qint64>(bytes, 0);
+        trim(this->limit_bytes);
+    }
+    [[nodiscard]] qint64 limit() const { return this->limit_bytes; }
+    [[nodiscard]] Stats_t stats() const {
+        return {this->hits, this->misses, this->evictions, this->total_bytes, this->limit_bytes, this->entries.size()};
+    }
+    void clear() {
+        this->lru.clear();
+        this->entries.clear();
+        this->total_bytes = 0;
+    }
+
+ private:
+    struct Entry_t {
+        QtGlyphKey_t key;
+        Value value;
+        qint64 cost;
+    };
+    using List_t = std::list<Entry_t>;
+
+    void trim(qint64 limit) {
+        while (this->total_bytes > limit && !this->lru.empty()) {
+            auto &entry = this->lru.back();
+            this->total_bytes -= entry.cost;
+            this->entries.remove(entry.key);
+            this->lru.pop_back();
+            ++this->evictions;
+        }
+    }
+    static qint64 costOf(const QPixmap &pixmap) {
+        return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    }
+    static qint64 costOf(const QImage &image) {
+        return image.sizeInBytes();
+    }
+
+    List_t lru; // most recently used at front
+    QHash<QtGlyphKey_t, typename List_t::iterator> entries;
+    qint64 limit_bytes = kDefaultPixmapCacheLimit;
+    qint64 total_bytes = 0;
+    qint64 hits = 0, misses = 0, evictions = 0;
+};
+using QtGlyphMaskCache = QtGlyphCache<QImage>;
+using QtGlyphPixmapCache = QtGlyphCache<QPixmap>;
+
+using QtIconFontDataPtr = QSharedPointer<QtIconFontData>;
+
+/**
+ * @brief loaded font, shared by the font objects of the same content and their handles.
+ *        it is immutable after loading, except the glyph caches which are only used in the gui thread,
+ *        and the lazily built search index, outlines and metrics which are guarded by mutexes.
+ */
+class QtIconFontData {
+ public:
+    using FontInfo_t = QtIconFont::FontInfo_t;
+    using FontInfoPtr_t = QtIconFont::FontInfoPtr_t;
+
+ public:
+    QString font_name;
+    QString description;
+    QString font_family;
+    QtGlyphTable glyphs;
+    QByteArray font_data; // shared with the font database, outlines are extracted from it
+    quint64 content_hash = 0; // hash of the font and the json or manifest bytes
+    int font_id = -1; // id in the font database, -1 if not registered
+    QString font_file_name;
+    QtIconFont::LoadTiming_t load_timing;
+    // every glyph is rasterized once per size and dpr as an alpha mask, tinted glyphs of recent colors are kept
+    // in a small hot cache. so recoloring on state changes costs one tint pass instead of a rasterization.
+    // masks are read from the mapped pack before they are rasterized, it outlives mask_cache which may wrap it
+    mutable QtGlyphDiskCache disk_cache;
+    mutable QtGlyphMaskCache mask_cache; // keys have no color
+    mutable QtGlyphPixmapCache pixmap_cache;
+    mutable QMutex search_index_mutex;
+    mutable QSharedPointer<const QtGlyphSearchIndex> search_index;
+    mutable QMutex outline_mutex; // guards paths and metrics
+    mutable QHash<uint32_t, QPainterPath> paths;
+    mutable QSharedPointer<const QtGlyphMetricsTable_t> metrics;
+
+ public:
+    static bool openFile(QFile *file);
+    /**
+     * @brief map the whole file, data wraps the mapping without copying it
+     * @param [in] source an open file, the mapping stays valid after it is closed or destroyed
+     * @return the mapped file which keeps the mapping alive, or null if it cannot be mapped
+     */
+    static QSharedPointer<QFile> mapFile(QFile *source, QByteArray *data);
+    static bool parseJsonData(const char *data, qint64 size, const QString &file_name, QtGlyphTable *table);
+    /**
+     * @brief read and parse files, or get the registered font of the same content without parsing.
+     *        it is safe to call in any thread
+     * @param [out] timing time spent in reading and parsing, optional
+     * @return null if failed
+     */
+    static QtIconFontDataPtr Load(QFile *font, QFile *json, QtIconFont::LoadTiming_t *timing = nullptr);
+    /**
+     * @brief register the loaded font to the font database, or get the registered font of the same content.
+     *        it must be called in the gui thread
+     * @return null if failed
+     */
+    static QtIconFontDataPtr Register(const QtIconFontDataPtr &data);
+    /**
+     * @brief create empty data which is destroyed in the gui thread. the last reference may be dropped in any
+     *        thread, e.g. by LoadAsync or QtIconFontLoader, while the glyph caches hold pixmaps
+     */
+    static QtIconFontDataPtr Create();
+    QtIconFontData() { setCacheLimit(kDefaultPixmapCacheLimit); }
+    // remove the font from the font database
+    ~QtIconFontData();
+    // get the glyph from the glyph caches, tint or render it on miss. gui thread only
+    [[nodiscard]] QPixmap glyphPixmap(const QtGlyphKey_t &key) const;
+    // render the glyph as a Format_Alpha8 image, the color of the key is ignored
+    [[nodiscard]] QImage renderMask(const QtGlyphKey_t &key) const;
+    void setCacheLimit(qint64 bytes) const;
+    [[nodiscard]] qint64 cacheLimit() const;
+    [[nodiscard]] QtIconFont::PixmapCacheStats_t cacheStats() const;
+    void clearCache() const;
+    // save the current pack and map the pack of this content in the directory, empty directory closes it. gui thread only
+    bool openDiskCache(const QString &directory) const;
+    // drop the masks which wrap the pack and save it, gui thread only
+    bool saveDiskCache() const;
+    // built on first use, it is safe to call in any thread
+    [[nodiscard]] QSharedPointer<const QtGlyphSearchIndex> searchIndex() const;
+    // get the info of glyph i which keeps data alive, null if i is out of range. it is safe to call in any thread
+    [[nodiscard]] static FontInfoPtr_t Info(const QSharedPointer<const QtIconFontData> &data, int i);
+    // extracted on first use and cached, it is safe to call in any thread
+    [[nodiscard]] QPainterPath glyphPath(uint32_t codepoint) const;
+    void preloadGlyphPaths() const;
+    // computed for all glyphs on first use, it is safe to call in any thread
+    [[nodiscard]] QSharedPointer<const QtGlyphMetricsTable_t> glyphMetrics() const;
+
+ private:
+    // a QRawFont is bound to the thread which creates it, so one is loaded from font_data per extraction
+    // in the calling thread at a pixel size of units per em, only the extracted outlines and metrics are shared
+    [[nodiscard]] QRawFont loadRawFont() const;
+    [[nodiscard]] QPainterPath extractPath(const QRawFont &raw_font, uint32_t codepoint) const;
+
+    // read files and hash the content, a json file is kept for parseGlyphs
+    bool readFiles(QFile *font, QFile *json);
+    bool parseGlyphs();
+    bool registerFont();
+    static QtIconFontDataPtr FindShared(quint64 content_hash);
+    static void Destroy(QtIconFontData *data);
+
+    QByteArray json_data; // wraps json_mapping if the file is mapped, until it is parsed
+    QSharedPointer<QFile> json_mapping;
+    QString json_file_name; // of the json or the manifest
+    bool json_pending = false;
+
+    // registered fonts by content hash, a font is removed from the font database when its last user goes away
+    static QMutex shared_mutex;
+    static QHash<quint64, QWeakPointer<QtIconFontData>> shared_fonts;
+};
+
+/**
+ * @brief registry of loaded fonts, lookups are wait-free and can run in any thread.
+ *
+ * it is a left-right register: writers are serialized and update two copies of the map in turn,
+ * readers only increase a counter of the copy they read, so the read path never blocks.
+ */
+class QtIconFontRegistry {
+ public:
+    struct Entry_t {
+        QtIconFont *font = nullptr;
+        QtIconFontDataPtr data;
+    };
+    using Map_t = QHash<QString, Entry_t>;
+
+ public:
+    [[nodiscard]] bool contains(const QString &name) const {
+        return read([&name](const Map_t &map) { return map.contains(name); });
+    }
+    [[nodiscard]] Entry_t value(const QString &name) const {
+        return read([&name](const Map_t &map) { return map.value(name); });
+    }
+    void insert(const QString &name, const Entry_t &entry) {
+        write([&](Map_t &map) { map.insert(name, entry); });
+    }
+    void remove(const QString &name) {
+        write([&name](Map_t &map) { map.remove(name); });
+    }
+
+ private:
+    template<class Func>
+    auto read(Func func) const {
+        auto version = this->version_index.loadAcquire();
+        this->readers[version].ref();
+        auto result = func(this->maps[this->left_right.loadAcquire()]);
+        this->readers[version].deref();
+        return result;
+    }
+    template<class Func>
+    void write(Func func) {
+        QMutexLocker locker(&this->write_mutex);
+        auto current = this->left_right.loadAcquire();
+        func(this->maps[1 - current]);
+        // new readers go to the updated copy
+        this->left_right.fetchAndStoreOrdered(1 - current);
+        // wait until no reader is left on the old copy, then update it too
+        auto version = this->version_index.loadAcquire();
+        waitForReaders(1 - version);
+        this->version_index.fetchAndStoreOrdered(1 - version);
+        waitForReaders(version);
+        func(this->maps[current]);
+    }
+    void waitForReaders(int version) const {
+        while (this->readers[version].loadAcquire() != 0) {
+            QThread::yieldCurrentThread();
+        }
+    }
+
+ private:
+    Map_t maps[2];
+    QAtomicInt left_right{0};
+    QAtomicInt version_index{0};
+    mutable QAtomicInt readers[2];
+    QMutex write_mutex;
+};
+
+class QtIconFontPrivate {
+ public:
+    QtIconFontDataPtr data{QtIconFontData::Create()};
+    QString alias_name;
+    QMetaObject::Connection save_disk_cache; // to aboutToQuit
+
+ public:
+    void attach(QtIconFont *q, const QtIconFontDataPtr &loaded);
+    void detach(QtIconFont *q);
+    // remove the alias from the registry if it points to q, or hand it over to another object of the same alias
+    void releaseName(QtIconFont *q);
+
+ public:
+    static QtIconFontRegistry loaded_fonts;
+    static QVector<QtIconFont *> instances; // valid font objects, gui thread only
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTICONFONT_P_H_
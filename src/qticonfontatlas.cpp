@@ -0,0 +1,240 @@
+#include "qticonfontatlas.h"
+#include "qticonfont_p.h"
+#include <QHash>
+#include <QPainter>
+#include <QtMath>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+static auto constexpr kDefaultPageSize = 1024;
+static auto constexpr kDefaultAtlasMemoryLimit = 16 * 1024 * 1024;
+static auto constexpr kGlyphPadding = 1; // transparent border, so scaled glyphs do not sample their neighbours
+
+class QtIconFontAtlasPrivate {
+ public:
+    explicit QtIconFontAtlasPrivate(QtIconFontHandle font) : font(std::move(font)) {}
+
+ public:
+    struct Shelf_t {
+        int y;
+        int height;
+        int x; // next free x
+    };
+    struct Page_t {
+        QPixmap pixmap;
+        QVector<Shelf_t> shelves;
+        int bottom = 0; // next free y
+        quint64 last_used = 0; // batch stamp
+        QVector<QtGlyphKey_t> keys;
+    };
+    struct Entry_t {
+        Page_t *page = nullptr;
+        QRect rect; // glyph rect in the page, without padding
+    };
+
+ public:
+    QtIconFontHandle font;
+    int page_size = kDefaultPageSize;
+    qint64 memory_limit = kDefaultAtlasMemoryLimit;
+    std::vector<std::unique_ptr<Page_t>> pages;
+    QHash<QtGlyphKey_t, Entry_t> entries;
+    quint64 batch = 0;
+    qint64 evictions = 0;
+
+ public:
+    [[nodiscard]] qint64 pageBytes() const { return qint64(this->page_size) * this->page_size * 4; }
+    Entry_t glyph(const QtGlyphKey_t &key);
+    bool allocate(Page_t *page, int width, int height, QRect *rect) const;
+    Page_t *newPage();
+    void renderGlyph(Page_t *page, const QRect &rect, const QtGlyphKey_t &key) const;
+    // evict least recently used pages which are not used by the current batch
+    void trim(qint64 limit);
+};
+
+QtIconFontAtlasPrivate::Entry_t QtIconFontAtlasPrivate::glyph(const QtGlyphKey_t &key) {
+    auto it = this->entries.find(key);
+    if (it != this->entries.end()) {
+        it->page->last_used = this->batch;
+        return *it;
+    }
+    auto extent = qCeil(key.pixel_size * key.dpr);
+    auto cell = extent + kGlyphPadding * 2;
+    if (cell > this->page_size) return {};
+
+    Page_t *target = nullptr;
+    QRect cell_rect;
+    for (auto &page : this->pages) {
+        if (allocate(page.get(), cell, cell, &cell_rect)) {
+            target = page.get();
+            break;
+        }
+    }
+    if (!target) {
+        target = newPage();
+        if (!allocate(target, cell, cell, &cell_rect)) return {};
+    }
+    Entry_t entry{target, cell_rect.adjusted(kGlyphPadding, kGlyphPadding, -kGlyphPadding, -kGlyphPadding)};
+    renderGlyph(target, entry.rect, key);
+    target->keys.append(key);
+    target->last_used = this->batch;
+    this->entries.insert(key, entry);
+    return entry;
+}
+
+bool QtIconFontAtlasPrivate::allocate(Page_t *page, int width, int height, QRect *rect) const {
+    // shelf packing: take the lowest shelf which fits, open a new shelf if the waste is too large
+    Shelf_t *best = nullptr;
+    for (auto &shelf : page->shelves) {
+        if (shelf.height >= height && shelf.x + width <= this->page_size
+            && (!best || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+    bool has_room = page->bottom + height <= this->page_size;
+    if (best && (best->height - height) * 2 > height && has_room) best = nullptr;
+    if (!best) {
+        if (!has_room) return false;
+        page->shelves.append({page->bottom, height, 0});
+        page->bottom += height;
+        best = &page->shelves.last();
+    }
+    *rect = QRect(best->x, best->y, width, height);
+    best->x += width;
+    return true;
+}
+
+QtIconFontAtlasPrivate::Page_t *QtIconFontAtlasPrivate::newPage() {
+    trim(this->memory_limit - pageBytes());
+    auto page = std::make_unique<Page_t>();
+    page->pixmap = QPixmap(this->page_size, this->page_size);
+    page->pixmap.fill(Qt::transparent);
+    this->pages.push_back(std::move(page));
+    return this->pages.back().get();
+}
+
+void QtIconFontAtlasPrivate::renderGlyph(Page_t *page, const QRect &rect, const QtGlyphKey_t &key) const {
+    // pages have a device pixel ratio of 1, the glyph is rendered in device pixels
+    QFont glyph_font(this->font.fontFamily());
+    glyph_font.setPixelSize(qMax(1, qRound(key.pixel_size * key.dpr)));
+    QPainter painter(&page->pixmap);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setFont(glyph_font);
+    painter.setPen(QColor::fromRgba(key.color));
+    painter.drawText(rect, Qt::AlignCenter, QString::fromUcs4(&key.codepoint, 1));
+}
+
+void QtIconFontAtlasPrivate::trim(qint64 limit) {
+    while (qint64(this->pages.size()) * pageBytes() > limit) {
+        auto victim = this->pages.end();
+        for (auto it = this->pages.begin(); it != this->pages.end(); ++it) {
+            if ((*it)->last_used == this->batch) continue;
+            if (victim == this->pages.end() || (*it)->last_used < (*victim)->last_used) victim = it;
+        }
+        if (victim == this->pages.end()) return;
+        for (auto const &key : (*victim)->keys) {
+            this->entries.remove(key);
+        }
+        this->pages.erase(victim);
+        ++this->evictions;
+    }
+}
+
+QtIconFontAtlas::QtIconFontAtlas(const QtIconFontHandle &font)
+    : d_ptr(new QtIconFontAtlasPrivate(font)) {
+}
+
+QtIconFontAtlas::QtIconFontAtlas(const QtIconFont *font)
+    : d_ptr(new QtIconFontAtlasPrivate(font ? font->handle() : QtIconFontHandle())) {
+}
+
+QtIconFontAtlas::~QtIconFontAtlas() {
+    delete d_ptr;
+}
+
+void QtIconFontAtlas::draw(QPainter *painter, const QVector<Icon_t> &icons, int size, const QColor &color) {
+    Q_D(QtIconFontAtlas);
+    if (!painter || !d->font.isValid() || size <= 0 || icons.isEmpty()) return;
+    auto dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    ++d->batch;
+
+    struct Batch_t {
+        const QtIconFontAtlasPrivate::Page_t *page;
+        QVector<QPainter::PixmapFragment> fragments;
+    };
+    std::vector<Batch_t> batches;
+    for (auto const &icon : icons) {
+        if (icon.rect.isEmpty()) continue;
+        auto info = d->font.fontInfoByClass(QStringView(icon.name));
+        if (!info) continue;
+        QtGlyphKey_t key{info->unicode_decimal, size, color.rgba(), dpr};
+        auto entry = d->glyph(key);
+        if (!entry.page) {
+            // larger than a page, draw it directly
+            QFont glyph_font = d->font.font();
+            glyph_font.setPixelSize(size);
+            painter->save();
+            painter->setFont(glyph_font);
+            painter->setPen(color);
+            painter->drawText(icon.rect, Qt::AlignCenter, QString::fromUcs4(&key.codepoint, 1));
+            painter->restore();
+            continue;
+        }
+        auto batch = std::find_if(batches.begin(), batches.end(),
+                                  [&entry](const Batch_t &b) { return b.page == entry.page; });
+        if (batch == batches.end()) {
+            batches.push_back({entry.page, {}});
+            batch = batches.end() - 1;
+        }
+        QRectF source(entry.rect);
+        batch->fragments.append(QPainter::PixmapFragment::create(
+            icon.rect.center(), source, icon.rect.width() / source.width(), icon.rect.height() / source.height()));
+    }
+    for (auto const &batch : batches) {
+        painter->drawPixmapFragments(batch.fragments.constData(), batch.fragments.size(), batch.page->pixmap);
+    }
+    d->trim(d->memory_limit);
+}
+
+void QtIconFontAtlas::draw(QPainter *painter, const QRectF &rect, const QString &name, int size, const QColor &color) {
+    draw(painter, QVector<Icon_t>{{name, rect}}, size, color);
+}
+
+void QtIconFontAtlas::setPageSize(int size) {
+    Q_D(QtIconFontAtlas);
+    if (size <= 0 || size == d->page_size) return;
+    clear();
+    d->page_size = size;
+}
+
+int QtIconFontAtlas::pageSize() const {
+    Q_D(const QtIconFontAtlas);
+    return d->page_size;
+}
+
+void QtIconFontAtlas::setMemoryLimit(qint64 bytes) {
+    Q_D(QtIconFontAtlas);
+    d->memory_limit = qMax<qint64>(0, bytes);
+    d->trim(d->memory_limit);
+}
+
+qint64 QtIconFontAtlas::memoryLimit() const {
+    Q_D(const QtIconFontAtlas);
+    return d->memory_limit;
+}
+
+QtIconFontAtlas::Stats_t QtIconFontAtlas::stats() const {
+    Q_D(const QtIconFontAtlas);
+    return {int(d->pages.size()), d->entries.size(), qint64(d->pages.size()) * d->pageBytes(),
+            d->memory_limit, d->evictions};
+}
+
+void QtIconFontAtlas::clear() {
+    Q_D(QtIconFontAtlas);
+    d->entries.clear();
+    d->pages.clear();
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
@@ -0,0 +1,70 @@
+#include "qticonfontengine_p.h"
+#include "qticonfont_p.h"
+#include <QPainter>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+static auto constexpr kDisabledOpacity = 0.4;
+
+QtIconFontEngine::QtIconFontEngine(QSharedPointer<const QtIconFontData> data, uint32_t codepoint,
+                                   const QString &name, const IconColors_t &colors)
+    : data(std::move(data)), codepoint(codepoint), name(name), colors(colors) {
+}
+
+void QtIconFontEngine::paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State) {
+    auto scale = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    auto pixmap = scaledPixmap(rect.size(), mode, scale);
+    if (pixmap.isNull()) return;
+    auto size = pixmap.size() / pixmap.devicePixelRatio();
+    painter->drawPixmap(QRect(rect.topLeft() + QPoint(rect.width() - size.width(), rect.height() - size.height()) / 2,
+                              size), pixmap);
+}
+
+QPixmap QtIconFontEngine::pixmap(const QSize &size, QIcon::Mode mode, QIcon::State) {
+    // QIcon passes the size in device pixels and sets the device pixel ratio of the result itself
+    return scaledPixmap(size, mode, 1.0);
+}
+
+QSize QtIconFontEngine::actualSize(const QSize &size, QIcon::Mode, QIcon::State) {
+    // glyphs are square
+    auto extent = qMin(size.width(), size.height());
+    return {extent, extent};
+}
+
+QString QtIconFontEngine::key() const {
+    return QStringLiteral("QtIconFontEngine");
+}
+
+QIconEngine *QtIconFontEngine::clone() const {
+    return new QtIconFontEngine(this->data, this->codepoint, this->name, this->colors);
+}
+
+QString QtIconFontEngine::iconName() const {
+    return this->name;
+}
+
+QColor QtIconFontEngine::color(QIcon::Mode mode) const {
+    switch (mode) {
+        case QIcon::Disabled: {
+            if (this->colors.disabled.isValid()) return this->colors.disabled;
+            auto disabled = this->colors.normal;
+            disabled.setAlphaF(disabled.alphaF() * kDisabledOpacity);
+            return disabled;
+        }
+        case QIcon::Active:
+            return this->colors.active.isValid() ? this->colors.active : this->colors.normal;
+        case QIcon::Selected:
+            return this->colors.selected.isValid() ? this->colors.selected : this->colors.normal;
+        case QIcon::Normal:
+        default:
+            return this->colors.normal;
+    }
+}
+
+QPixmap QtIconFontEngine::scaledPixmap(const QSize &size, QIcon::Mode mode, qreal scale) const {
+    auto extent = qMin(size.width(), size.height());
+    if (!this->data || extent <= 0 || scale <= 0) return {};
+    return this->data->glyphPixmap({this->codepoint, extent, color(mode).rgba(), scale});
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
@@ -0,0 +1,46 @@
+#ifndef QTWIDGETS_SRC_QTICONFONTENGINE_P_H_
+#define QTWIDGETS_SRC_QTICONFONTENGINE_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include "qticonfont.h"
+#include <QIconEngine>
+#include <QSharedPointer>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief icon engine of one glyph, pixmaps are rendered on demand at the requested size and device pixel ratio.
+ *        the glyph data is shared with the font, so the icon stays valid after the QtIconFont object is deleted.
+ */
+class QtIconFontEngine : public QIconEngine {
+ public:
+    using IconColors_t = QtIconFont::IconColors_t;
+
+ public:
+    QtIconFontEngine(QSharedPointer<const QtIconFontData> data, uint32_t codepoint,
+                     const QString &name, const IconColors_t &colors);
+
+ public:
+    void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state) override;
+    QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state) override;
+    QSize actualSize(const QSize &size, QIcon::Mode mode, QIcon::State state) override;
+    [[nodiscard]] QString key() const override;
+    [[nodiscard]] QIconEngine *clone() const override;
+    QString iconName() const override;
+
+ private:
+    [[nodiscard]] QColor color(QIcon::Mode mode) const;
+    [[nodiscard]] QPixmap scaledPixmap(const QSize &size, QIcon::Mode mode, qreal scale) const;
+
+ private:
+    QSharedPointer<const QtIconFontData> data;
+    uint32_t codepoint;
+    QString name;
+    IconColors_t colors;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTICONFONTENGINE_P_H_
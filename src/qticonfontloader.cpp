@@ -0,0 +1,116 @@
+#include "qticonfontloader.h"
+#include "qticonfont_p.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+using Timing_t = QtIconFontLoader::Timing_t;
+
+class QtIconFontLoaderPrivate {
+ public:
+    QVector<QPair<QString, QString>> files; // font, json
+    QVector<Timing_t> timings;
+    qint64 elapsed = 0;
+};
+
+static QString FormatMs(qint64 ns) {
+    return QString::number(double(ns) / 1e6, 'f', 2) + QStringLiteral(" ms");
+}
+
+QtIconFontLoader::QtIconFontLoader() : d_ptr(new QtIconFontLoaderPrivate) {
+}
+
+QtIconFontLoader::~QtIconFontLoader() {
+    delete d_ptr;
+}
+
+void QtIconFontLoader::addFont(const QString &font, const QString &json) {
+    Q_D(QtIconFontLoader);
+    d->files.append({font, json});
+}
+
+int QtIconFontLoader::count() const {
+    Q_D(const QtIconFontLoader);
+    return d->files.size();
+}
+
+QVector<QtIconFont *> QtIconFontLoader::load(QObject *parent) {
+    Q_D(QtIconFontLoader);
+    QElapsedTimer timer;
+    timer.start();
+    d->timings.clear();
+    d->timings.reserve(d->files.size());
+
+    struct Parsed_t {
+        QtIconFontDataPtr data; // null if failed
+        QtIconFont::LoadTiming_t timing;
+    };
+    QVector<QFuture<Parsed_t>> parsing;
+    parsing.reserve(d->files.size());
+    for (auto const &file : d->files) {
+        parsing.append(QtConcurrent::run([file]() -> Parsed_t {
+            QFile font_file(file.first);
+            QFile json_file(file.second);
+            Parsed_t parsed;
+            parsed.data = QtIconFontData::Load(&font_file, &json_file, &parsed.timing);
+            return parsed;
+        }));
+    }
+
+    // the font database is only used in the gui thread, fonts are registered one by one while the rest are parsed
+    QVector<QtIconFont *> fonts;
+    for (int i = 0; i < parsing.size(); ++i) {
+        auto parsed = parsing[i].result();
+        Timing_t timing;
+        timing.font = d->files[i].first;
+        timing.json = d->files[i].second;
+        timing.timing = parsed.timing;
+        QElapsedTimer register_timer;
+        register_timer.start();
+        // fonts of the same content are shared, they are registered once
+        auto data = QtIconFontData::Register(parsed.data);
+        timing.timing.register_ns = register_timer.nsecsElapsed();
+        timing.loaded = !data.isNull();
+        if (timing.loaded) fonts.append(new QtIconFont(data, parent));
+        d->timings.append(timing);
+    }
+    d->elapsed = timer.nsecsElapsed();
+    return fonts;
+}
+
+QVector<Timing_t> QtIconFontLoader::timings() const {
+    Q_D(const QtIconFontLoader);
+    return d->timings;
+}
+
+qint64 QtIconFontLoader::elapsed() const {
+    Q_D(const QtIconFontLoader);
+    return d->elapsed;
+}
+
+QString QtIconFontLoader::report() const {
+    Q_D(const QtIconFontLoader);
+    QString report;
+    QtIconFont::LoadTiming_t total;
+    int loaded = 0;
+    for (auto const &timing : d->timings) {
+        report += QStringLiteral("%1: read %2, parse %3, register %4%5\n")
+            .arg(QFileInfo(timing.font).fileName(), FormatMs(timing.timing.read_ns),
+                 FormatMs(timing.timing.parse_ns), FormatMs(timing.timing.register_ns),
+                 timing.loaded ? QString() : QStringLiteral(", failed"));
+        total.read_ns += timing.timing.read_ns;
+        total.parse_ns += timing.timing.parse_ns;
+        total.register_ns += timing.timing.register_ns;
+        loaded += timing.loaded ? 1 : 0;
+    }
+    // read and parse run concurrently, so the wall time is less than the sum of the steps
+    report += QStringLiteral("total: %1/%2 fonts loaded in %3, read %4, parse %5, register %6")
+        .arg(loaded).arg(d->timings.size())
+        .arg(FormatMs(d->elapsed), FormatMs(total.read_ns), FormatMs(total.parse_ns), FormatMs(total.register_ns));
+    return report;
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
@@ -0,0 +1,158 @@
+#include "qticonfontsearch.h"
+#include "qticonfont_p.h"
+#include <QHash>
+#include <QMutexLocker>
+#include <QtConcurrent>
+#include <algorithm>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+using Match_t = QtIconFontSearch::Match_t;
+
+static auto constexpr kCancelCheckInterval = 256;
+
+class QtIconFontSearchPrivate {
+ public:
+    // shared with running searches, so they can finish after the search object is deleted
+    struct State_t {
+        QSharedPointer<const QtIconFontData> data;
+        QtIconFontSearch::MatchMode mode;
+        QAtomicInteger<quint64> generation{0};
+
+        QMutex mutex;
+        QString last_query; // case folded
+        QVector<int> last_entries; // entries matching last_query
+
+        QVector<Match_t> run(const QString &query, int limit, quint64 current);
+    };
+
+ public:
+    QSharedPointer<State_t> state{new State_t};
+};
+
+QVector<Match_t> QtIconFontSearchPrivate::State_t::run(const QString &query, int limit, quint64 current) {
+    auto cancelled = [this, current] { return this->generation.loadAcquire() != current; };
+    if (!this->data) return {};
+    auto folded = query.trimmed().toCaseFolded();
+    if (folded.isEmpty()) {
+        QMutexLocker locker(&this->mutex);
+        this->last_query.clear();
+        this->last_entries.clear();
+        return {};
+    }
+    auto index = this->data->searchIndex();
+
+    // entries matching a query also match its prefixes, so an extended query only searches the previous results
+    QVector<int> candidates;
+    bool narrowed = false;
+    {
+        QMutexLocker locker(&this->mutex);
+        if (!this->last_query.isEmpty() && folded.startsWith(this->last_query)) {
+            candidates = this->last_entries;
+            narrowed = true;
+        }
+    }
+    if (!narrowed && this->mode == QtIconFontSearch::PrefixMatch) {
+        candidates = index->prefixEntries(folded);
+        narrowed = true;
+    }
+
+    QVector<QPair<int, int>> matched; // entry, score
+    auto total = narrowed ? candidates.size() : index->entryCount();
+    for (int i = 0; i < total; ++i) {
+        if (i % kCancelCheckInterval == 0 && cancelled()) return {};
+        auto entry = narrowed ? candidates[i] : i;
+        if (this->mode == QtIconFontSearch::PrefixMatch && !QStringView(index->key(entry)).startsWith(folded)) {
+            continue;
+        }
+        auto score = index->score(entry, folded);
+        if (score > 0) matched.append({entry, score});
+    }
+    {
+        QMutexLocker locker(&this->mutex);
+        if (cancelled()) return {};
+        this->last_query = folded;
+        this->last_entries.clear();
+        this->last_entries.reserve(matched.size());
+        for (auto const &match : matched) this->last_entries.append(match.first);
+    }
+
+    // rank glyphs by their best entry, shorter class names first on ties
+    QHash<int, int> best;
+    for (auto const &match : matched) {
+        auto &score = best[QtGlyphSearchIndex::glyphOf(match.first)];
+        score = qMax(score, match.second);
+    }
+    QVector<QPair<int, int>> glyphs; // glyph, score
+    glyphs.reserve(best.size());
+    for (auto it = best.cbegin(); it != best.cend(); ++it) glyphs.append({it.key(), it.value()});
+    auto better = [&index](const QPair<int, int> &a, const QPair<int, int> &b) {
+        if (a.second != b.second) return a.second > b.second;
+        auto const &key_a = index->key(a.first * 2), &key_b = index->key(b.first * 2);
+        if (key_a.size() != key_b.size()) return key_a.size() < key_b.size();
+        return key_a < key_b;
+    };
+    if (limit >= 0 && limit < glyphs.size()) {
+        std::partial_sort(glyphs.begin(), glyphs.begin() + limit, glyphs.end(), better);
+        glyphs.resize(limit);
+    } else {
+        std::sort(glyphs.begin(), glyphs.end(), better);
+    }
+
+    QVector<Match_t> results;
+    results.reserve(glyphs.size());
+    for (auto const &glyph : glyphs) {
+        results.append({QtIconFontData::Info(this->data, glyph.first), glyph.second});
+    }
+    return results;
+}
+
+QtIconFontSearch::QtIconFontSearch(const QtIconFontHandle &font, MatchMode mode)
+    : d_ptr(new QtIconFontSearchPrivate) {
+    Q_D(QtIconFontSearch);
+    d->state->data = font.data;
+    d->state->mode = mode;
+}
+
+QtIconFontSearch::QtIconFontSearch(const QtIconFont *font, MatchMode mode)
+    : QtIconFontSearch(font ? font->handle() : QtIconFontHandle(), mode) {
+}
+
+QtIconFontSearch::~QtIconFontSearch() {
+    cancel();
+    delete d_ptr;
+}
+
+QVector<Match_t> QtIconFontSearch::search(const QString &query, int limit) {
+    Q_D(QtIconFontSearch);
+    auto current = d->state->generation.fetchAndAddOrdered(1) + 1;
+    return d->state->run(query, limit, current);
+}
+
+QFuture<QVector<Match_t>> QtIconFontSearch::searchAsync(const QString &query, int limit) {
+    Q_D(QtIconFontSearch);
+    auto current = d->state->generation.fetchAndAddOrdered(1) + 1;
+    auto state = d->state;
+    return QtConcurrent::run([state, query, limit, current] {
+        return state->run(query, limit, current);
+    });
+}
+
+void QtIconFontSearch::cancel() {
+    Q_D(QtIconFontSearch);
+    d->state->generation.fetchAndAddOrdered(1);
+}
+
+void QtIconFontSearch::reset() {
+    Q_D(QtIconFontSearch);
+    QMutexLocker locker(&d->state->mutex);
+    d->state->last_query.clear();
+    d->state->last_entries.clear();
+}
+
+QtIconFontSearch::MatchMode QtIconFontSearch::matchMode() const {
+    Q_D(const QtIconFontSearch);
+    return d->state->mode;
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
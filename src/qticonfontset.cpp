@@ -0,0 +1,281 @@
+#include "qticonfontset.h"
+#include "qticonfont_p.h"
+#include <algorithm>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+using Glyph_t = QtIconFontSet::Glyph_t;
+
+static auto constexpr kMinSetCapacity = 16;
+
+class QtIconFontSetPrivate {
+ public:
+    struct Member_t {
+        QString name;
+        int priority = 0;
+        int order = 0; // insertion order, earlier members win on equal priority
+        QtIconFontHandle handle;
+        QSharedPointer<const QtIconFontData> data; // null if removed
+    };
+    struct Slot_t {
+        quint32 hash;
+        int member; // -1 means empty
+        int glyph;
+    };
+    // open-addressing index with linear probing, keys are read from the member's glyph table
+    struct Index_t {
+        QtGlyphTable::Index key_index;
+        QVector<Slot_t> entries;
+        int count = 0;
+    };
+
+ public:
+    QVector<Member_t> members; // ids are indexes, ids of removed members are reused by the next added member
+    Index_t indexes[2] = {{QtGlyphTable::FontClassIndex, {}, 0}, {QtGlyphTable::IconIdIndex, {}, 0}};
+    int next_order = 0;
+
+ public:
+    [[nodiscard]] int memberOf(const QString &name) const;
+    [[nodiscard]] bool beats(int a, int b) const;
+    [[nodiscard]] QStringView keyOf(const Index_t &index, int member, int glyph) const;
+    template<class Key>
+    [[nodiscard]] int findSlot(const Index_t &index, Key key, quint32 hash) const;
+    template<class Key>
+    [[nodiscard]] Glyph_t lookup(const Index_t &index, Key key) const;
+    void insertMember(int member);
+    void removeMember(int member);
+    void grow(Index_t *index);
+    void erase(Index_t *index, int pos);
+};
+
+int QtIconFontSetPrivate::memberOf(const QString &name) const {
+    for (int i = 0; i < this->members.size(); ++i) {
+        if (this->members[i].data && this->members[i].name == name) return i;
+    }
+    return -1;
+}
+
+bool QtIconFontSetPrivate::beats(int a, int b) const {
+    auto const &member_a = this->members[a], &member_b = this->members[b];
+    if (member_a.priority != member_b.priority) return member_a.priority > member_b.priority;
+    return member_a.order < member_b.order;
+}
+
+QStringView QtIconFontSetPrivate::keyOf(const Index_t &index, int member, int glyph) const {
+    auto const &glyphs = this->members[member].data->glyphs;
+    auto const &record = glyphs.record(glyph);
+    return glyphs.string(index.key_index == QtGlyphTable::FontClassIndex ? record.font_class : record.icon_id);
+}
+
+template<class Key>
+int QtIconFontSetPrivate::findSlot(const Index_t &index, Key key, quint32 hash) const {
+    if (index.entries.isEmpty()) return -1;
+    auto mask = index.entries.size() - 1;
+    for (auto pos = int(hash) & mask;; pos = (pos + 1) & mask) {
+        auto const &slot = index.entries[pos];
+        if (slot.member < 0) return -1;
+        if (slot.hash == hash && QtGlyphTable::keyEquals(keyOf(index, slot.member, slot.glyph), key)) return pos;
+    }
+}
+
+template<class Key>
+Glyph_t QtIconFontSetPrivate::lookup(const Index_t &index, Key key) const {
+    auto pos = findSlot(index, key, QtGlyphTable::hashKey(key));
+    if (pos < 0) return {};
+    auto const &slot = index.entries[pos];
+    auto const &member = this->members[slot.member];
+    return {QtIconFontData::Info(member.data, slot.glyph), member.handle};
+}
+
+void QtIconFontSetPrivate::insertMember(int member) {
+    auto const &glyphs = this->members[member].data->glyphs;
+    for (auto &index : this->indexes) {
+        for (int glyph = 0; glyph < glyphs.size(); ++glyph) {
+            auto key = keyOf(index, member, glyph);
+            auto hash = QtGlyphTable::hashKey(key);
+            auto pos = findSlot(index, key, hash);
+            if (pos >= 0) {
+                // later glyphs of the same member win, same as QtIconFont
+                auto &slot = index.entries[pos];
+                if (slot.member == member || beats(member, slot.member)) slot = {hash, member, glyph};
+                continue;
+            }
+            if ((index.count + 1) * 2 > index.entries.size()) grow(&index);
+            auto mask = index.entries.size() - 1;
+            auto free = int(hash) & mask;
+            while (index.entries[free].member >= 0) free = (free + 1) & mask;
+            index.entries[free] = {hash, member, glyph};
+            ++index.count;
+        }
+    }
+}
+
+void QtIconFontSetPrivate::removeMember(int member) {
+    auto const &glyphs = this->members[member].data->glyphs;
+    for (auto &index : this->indexes) {
+        for (int glyph = 0; glyph < glyphs.size(); ++glyph) {
+            auto key = keyOf(index, member, glyph);
+            auto hash = QtGlyphTable::hashKey(key);
+            auto pos = findSlot(index, key, hash);
+            if (pos < 0 || index.entries[pos].member != member) continue;
+            // fall back to the best of the other members
+            int fallback = -1, fallback_glyph = -1;
+            for (int other = 0; other < this->members.size(); ++other) {
+                if (other == member || !this->members[other].data) continue;
+                auto found = this->members[other].data->glyphs.find(index.key_index, key);
+                if (found >= 0 && (fallback < 0 || beats(other, fallback))) {
+                    fallback = other;
+                    fallback_glyph = found;
+                }
+            }
+            if (fallback >= 0) {
+                index.entries[pos] = {hash, fallback, fallback_glyph};
+            } else {
+                erase(&index, pos);
+            }
+        }
+    }
+}
+
+void QtIconFontSetPrivate::grow(Index_t *index) {
+    auto old_entries = index->entries;
+    auto capacity = qMax(kMinSetCapacity, old_entries.size() * 2);
+    index->entries.fill({0, -1, -1}, capacity);
+    auto mask = capacity - 1;
+    for (auto const &slot : old_entries) {
+        if (slot.member < 0) continue;
+        auto pos = int(slot.hash) & mask;
+        while (index->entries[pos].member >= 0) pos = (pos + 1) & mask;
+        index->entries[pos] = slot;
+    }
+}
+
+void QtIconFontSetPrivate::erase(Index_t *index, int pos) {
+    // backward shift deletion, so probe sequences stay unbroken without tombstones
+    auto mask = index->entries.size() - 1;
+    auto hole = pos;
+    for (auto next = (hole + 1) & mask; index->entries[next].member >= 0; next = (next + 1) & mask) {
+        auto home = int(index->entries[next].hash) & mask;
+        // move the slot into the hole if the hole lies between its home and its current position
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->entries[hole] = index->entries[next];
+            hole = next;
+        }
+    }
+    index->entries[hole] = {0, -1, -1};
+    --index->count;
+}
+
+QString QtIconFontSet::Glyph_t::text() const {
+    if (!this->info) return {};
+    auto code = uint(this->info->unicode_decimal);
+    return QString::fromUcs4(&code, 1);
+}
+
+QtIconFontSet::QtIconFontSet() : d_ptr(new QtIconFontSetPrivate) {
+}
+
+QtIconFontSet::~QtIconFontSet() {
+    delete d_ptr;
+}
+
+bool QtIconFontSet::addFont(const QString &font_name, int priority) {
+    Q_D(QtIconFontSet);
+    if (d->memberOf(font_name) >= 0) return false;
+    auto handle = QtIconFont::AcquireIconFont(font_name);
+    if (!handle.isValid()) return false;
+    QtIconFontSetPrivate::Member_t member;
+    member.name = font_name;
+    member.priority = priority;
+    member.order = d->next_order++;
+    member.data = handle.data;
+    member.handle = std::move(handle);
+    // the index no longer refers to a removed member, so its id is free. the order decides ties, not the id
+    auto id = 0;
+    while (id < d->members.size() && d->members[id].data) ++id;
+    if (id == d->members.size()) {
+        d->members.append(member);
+    } else {
+        d->members[id] = member;
+    }
+    d->insertMember(id);
+    return true;
+}
+
+bool QtIconFontSet::addFont(const QtIconFont *font, int priority) {
+    if (!font) return false;
+    return addFont(font->aliasName(), priority);
+}
+
+bool QtIconFontSet::removeFont(const QString &font_name) {
+    Q_D(QtIconFontSet);
+    auto member = d->memberOf(font_name);
+    if (member < 0) return false;
+    d->removeMember(member);
+    d->members[member] = {};
+    return true;
+}
+
+bool QtIconFontSet::reloadFont(const QString &font_name) {
+    Q_D(QtIconFontSet);
+    auto member = d->memberOf(font_name);
+    if (member < 0) return false;
+    auto handle = QtIconFont::AcquireIconFont(font_name);
+    d->removeMember(member);
+    if (!handle.isValid()) {
+        d->members[member] = {};
+        return false;
+    }
+    // the member keeps its id, priority and order
+    d->members[member].data = handle.data;
+    d->members[member].handle = std::move(handle);
+    d->insertMember(member);
+    return true;
+}
+
+QStringList QtIconFontSet::fonts() const {
+    Q_D(const QtIconFontSet);
+    QVector<int> alive;
+    for (int i = 0; i < d->members.size(); ++i) {
+        if (d->members[i].data) alive.append(i);
+    }
+    std::sort(alive.begin(), alive.end(), [d](int a, int b) { return d->beats(a, b); });
+    QStringList names;
+    for (auto member : alive) names.append(d->members[member].name);
+    return names;
+}
+
+bool QtIconFontSet::contains(const QString &font_name) const {
+    Q_D(const QtIconFontSet);
+    return d->memberOf(font_name) >= 0;
+}
+
+Glyph_t QtIconFontSet::glyphByClass(const QString &name) const {
+    return glyphByClass(QStringView(name));
+}
+
+Glyph_t QtIconFontSet::glyphByClass(QStringView name) const {
+    Q_D(const QtIconFontSet);
+    return d->lookup(d->indexes[0], name);
+}
+
+Glyph_t QtIconFontSet::glyphByClass(QLatin1String name) const {
+    Q_D(const QtIconFontSet);
+    return d->lookup(d->indexes[0], name);
+}
+
+Glyph_t QtIconFontSet::glyphById(const QString &id) const {
+    return glyphById(QStringView(id));
+}
+
+Glyph_t QtIconFontSet::glyphById(QStringView id) const {
+    Q_D(const QtIconFontSet);
+    return d->lookup(d->indexes[1], id);
+}
+
+Glyph_t QtIconFontSet::glyphById(QLatin1String id) const {
+    Q_D(const QtIconFontSet);
+    return d->lookup(d->indexes[1], id);
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
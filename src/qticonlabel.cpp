@@ -0,0 +1,176 @@
+#include "qticonlabel.h"
+#include "qticonfont_p.h"
+#include <QEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QStyle>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+static auto constexpr kDefaultIconSize = 16;
+
+class QtIconLabelPrivate {
+ public:
+    explicit QtIconLabelPrivate(QtIconLabel *q) : q_ptr(q) {}
+    ~QtIconLabelPrivate() = default;
+
+ public:
+    QtIconFontHandle font;
+    QSharedPointer<const QtIconFontData> data;
+    QString name;
+    QColor color;
+    int size = kDefaultIconSize;
+    Qt::Alignment alignment = Qt::AlignCenter;
+
+    uint32_t codepoint = 0; // 0 if the glyph is not found
+    QPixmap pixmap; // the glyph from the pixmap cache, null if it must be fetched again
+
+ public:
+    void resolve();
+    [[nodiscard]] QRect iconRect() const;
+
+ private:
+    Q_DECLARE_PUBLIC(QtIconLabel);
+    QtIconLabel *q_ptr;
+};
+
+void QtIconLabelPrivate::resolve() {
+    this->pixmap = {};
+    this->codepoint = 0;
+    if (!this->data || this->name.isEmpty()) return;
+    auto i = this->data->glyphs.find(QtGlyphTable::FontClassIndex, QStringView(this->name));
+    if (i >= 0) this->codepoint = this->data->glyphs.record(i).unicode_decimal;
+}
+
+QRect QtIconLabelPrivate::iconRect() const {
+    Q_Q(const QtIconLabel);
+    return QStyle::alignedRect(q->layoutDirection(), this->alignment, QSize(this->size, this->size),
+                               q->contentsRect());
+}
+
+QtIconLabel::QtIconLabel(QWidget *parent)
+    : QWidget(parent), d_ptr(new QtIconLabelPrivate(this)) {
+}
+
+QtIconLabel::QtIconLabel(const QtIconFont *font, const QString &name, QWidget *parent)
+    : QtIconLabel(parent) {
+    Q_D(QtIconLabel);
+    d->name = name;
+    setIconFont(font);
+}
+
+QtIconLabel::~QtIconLabel() {
+    delete d_ptr;
+}
+
+void QtIconLabel::setIconFont(const QtIconFont *font) {
+    setIconFont(font ? font->handle() : QtIconFontHandle());
+}
+
+void QtIconLabel::setIconFont(const QtIconFontHandle &font) {
+    Q_D(QtIconLabel);
+    d->font = font;
+    d->data = font.data;
+    d->resolve();
+    QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
+}
+
+QtIconFontHandle QtIconLabel::iconFont() const {
+    Q_D(const QtIconLabel);
+    return d->font;
+}
+
+void QtIconLabel::setIconName(const QString &name) {
+    Q_D(QtIconLabel);
+    if (d->name == name) return;
+    d->name = name;
+    d->resolve();
+    QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
+}
+
+QString QtIconLabel::iconName() const {
+    Q_D(const QtIconLabel);
+    return d->name;
+}
+
+void QtIconLabel::setIconColor(const QColor &color) {
+    Q_D(QtIconLabel);
+    if (d->color == color) return;
+    d->color = color;
+    d->pixmap = {};
+    QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
+}
+
+QColor QtIconLabel::iconColor() const {
+    Q_D(const QtIconLabel);
+    return d->color.isValid() ? d->color : this->palette().color(QPalette::WindowText);
+}
+
+void QtIconLabel::setIconSize(int size) {
+    Q_D(QtIconLabel);
+    if (d->size == size) return;
+    d->size = size;
+    d->pixmap = {};
+    updateGeometry();
+    QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
+}
+
+int QtIconLabel::iconSize() const {
+    Q_D(const QtIconLabel);
+    return d->size;
+}
+
+void QtIconLabel::setIconAlignment(Qt::Alignment alignment) {
+    Q_D(QtIconLabel);
+    d->alignment = alignment;
+    QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
+}
+
+Qt::Alignment QtIconLabel::iconAlignment() const {
+    Q_D(const QtIconLabel);
+    return d->alignment;
+}
+
+QSize QtIconLabel::sizeHint() const {
+    Q_D(const QtIconLabel);
+    auto margins = this->contentsMargins();
+    return QSize(d->size, d->size).grownBy(margins);
+}
+
+QSize QtIconLabel::minimumSizeHint() const {
+    return sizeHint();
+}
+
+void QtIconLabel::paintEvent(QPaintEvent *event) {
+    Q_D(QtIconLabel);
+    QPainter painter(this);
+    // an opaque widget must paint every pixel of the region, nothing below it is painted
+    if (this->testAttribute(Qt::WA_OpaquePaintEvent)) {
+        painter.fillRect(event->rect(), this->palette().brush(this->backgroundRole()));
+    }
+    if (!d->data || d->codepoint == 0 || d->size <= 0) return;
+    auto rect = d->iconRect();
+    if (!event->region().intersects(rect)) return;
+    // the device pixel ratio changes when the widget moves to another screen
+    auto dpr = this->devicePixelRatioF();
+    if (d->pixmap.isNull() || d->pixmap.devicePixelRatio() != dpr) {
+        d->pixmap = d->data->glyphPixmap({d->codepoint, d->size, iconColor().rgba(), dpr});
+    }
+    painter.drawPixmap(rect.topLeft(), d->pixmap);
+}
+
+void QtIconLabel::changeEvent(QEvent *event) {
+    Q_D(QtIconLabel);
+    switch (event->type()) {
+        case QEvent::PaletteChange:
+        case QEvent::EnabledChange:
+            // the default color follows the palette
+            if (!d->color.isValid()) d->pixmap = {};
+            break;
+        default:
+            break;
+    }
+    QWidget::changeEvent(event);
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
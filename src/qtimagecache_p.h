@@ -0,0 +1,207 @@
+#ifndef QTWIDGETS_SRC_QTIMAGECACHE_P_H_
+#define QTWIDGETS_SRC_QTIMAGECACHE_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPixmap>
+#include <QSharedPointer>
+#include <QSize>
+#include <QVector>
+
+static auto constexpr kDefaultPyramidLimit = 64 * 1024 * 1024;
+static auto constexpr kDefaultSharedCacheLimit = 128 * 1024 * 1024;
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief power-of-two pyramid of a source image, levels are built on demand and shared with scaling jobs.
+ *        level 0 is the source, each level is half the size of the previous one.
+ */
+class QtImagePyramid {
+ public:
+    QtImagePyramid(const QImage &source, qint64 limit) : levels{source}, limit_bytes(limit) {}
+
+ public:
+    /**
+     * @brief get the smallest level which is not smaller than size, missing levels are built from the one above.
+     *        levels over the memory limit are built but not kept. it is safe to call in any thread
+     */
+    QImage levelFor(const QSize &size) {
+        QMutexLocker locker(&this->mutex);
+        auto level = this->levels.first();
+        for (int i = 1;; ++i) {
+            auto half = QSize(level.width() / 2, level.height() / 2);
+            if (half.width() < size.width() || half.height() < size.height() || half.isEmpty()) return level;
+            if (i < this->levels.size() && !this->levels[i].isNull()) {
+                level = this->levels[i];
+                continue;
+            }
+            // the level is built without the lock, so jobs reading kept levels are not blocked meanwhile.
+            // a 2x smooth reduction averages each 2x2 block, so every level is a faithful source for the next
+            locker.unlock();
+            auto built = level.scaled(half, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            locker.relock();
+            // another job may have published it meanwhile, the first one is kept
+            if (i < this->levels.size() && !this->levels[i].isNull()) {
+                level = this->levels[i];
+                continue;
+            }
+            level = built;
+            if (this->used_bytes + level.sizeInBytes() <= this->limit_bytes) {
+                if (i >= this->levels.size()) this->levels.resize(i + 1);
+                this->levels[i] = level;
+                this->used_bytes += level.sizeInBytes();
+            }
+        }
+    }
+    // bytes of the kept downscaled levels
+    [[nodiscard]] qint64 usedBytes() const {
+        QMutexLocker locker(&this->mutex);
+        return this->used_bytes;
+    }
+
+ private:
+    mutable QMutex mutex;
+    QVector<QImage> levels; // null if the level is not kept
+    qint64 limit_bytes;
+    qint64 used_bytes = 0; // of the downscaled levels, the source is not counted
+};
+
+/**
+ * @brief key of a scaled image
+ */
+struct QtScaledImageKey_t {
+    qint64 source = 0; // QPixmap::cacheKey
+    QSize size;
+    Qt::AspectRatioMode mode = Qt::KeepAspectRatio;
+    qreal dpr = 1.0;
+};
+
+inline bool operator==(const QtScaledImageKey_t &a, const QtScaledImageKey_t &b) {
+    return a.source == b.source && a.size == b.size && a.mode == b.mode && a.dpr == b.dpr;
+}
+
+inline uint qHash(const QtScaledImageKey_t &key, uint seed = 0) {
+    auto size = (quint64(quint32(key.size.width())) << 32) | quint32(key.size.height());
+    return ::qHash(key.source, seed) ^ ::qHash(size, seed) ^ ::qHash(int(key.mode), seed) ^ ::qHash(key.dpr, seed);
+}
+
+/**
+ * @brief scaled images shared by all image widgets, it is used in the gui thread only.
+ *        widgets showing the same pixmap at the same size hold the same entry, so it is scaled once and kept once.
+ *        entries no widget holds are kept within the memory limit, the least recently used are dropped first.
+ */
+class QtScaledImageCache {
+ public:
+    struct Entry_t {
+        QPixmap pixmap; // null until scaled
+        bool scaling = false; // job is running
+        QFuture<QImage> job;
+        QSharedPointer<QAtomicInt> users{new QAtomicInt(0)}; // read by the job, which is skipped if nobody waits
+        quint64 last_use = 0;
+    };
+
+ public:
+    static QtScaledImageCache &Instance() {
+        static QtScaledImageCache cache;
+        return cache;
+    }
+
+ public:
+    /**
+     * @brief hold the entry of key, it is created if missing. the pointer is valid until the next call
+     */
+    Entry_t *acquire(const QtScaledImageKey_t &key) {
+        // pixmaps must not outlive the application. the cache may be created before it, so it is watched
+        // from the first entry made while it exists. entries still held are released by their widgets
+        if (!this->quit_watched && qApp) {
+            QObject::connect(qApp, &QCoreApplication::aboutToQuit, [] {
+                auto &cache = Instance();
+                cache.quitting = true;
+                cache.trim(0);
+            });
+            this->quit_watched = true;
+        }
+        auto &entry = this->entries[key];
+        entry.users->ref();
+        entry.last_use = ++this->tick;
+        return &entry;
+    }
+    void release(const QtScaledImageKey_t &key) {
+        auto iter = this->entries.find(key);
+        if (iter == this->entries.end()) return;
+        if (iter->users->deref()) return;
+        // an unfinished entry nobody waits for is dropped, its job returns early if it has not started yet
+        if (iter->pixmap.isNull()) {
+            this->entries.erase(iter);
+            return;
+        }
+        trim(keptBytes());
+    }
+    [[nodiscard]] QPixmap find(const QtScaledImageKey_t &key) const {
+        auto iter = this->entries.constFind(key);
+        return iter == this->entries.constEnd() ? QPixmap() : iter->pixmap;
+    }
+    /**
+     * @brief set the scaled image of key if it is not set yet, and get the pixmap all holders share
+     */
+    QPixmap store(const QtScaledImageKey_t &key, const QPixmap &pixmap) {
+        auto iter = this->entries.find(key);
+        if (iter == this->entries.end()) return pixmap;
+        if (iter->pixmap.isNull()) {
+            iter->pixmap = pixmap;
+            iter->scaling = false;
+            iter->job = QFuture<QImage>();
+            this->used_bytes += BytesOf(pixmap);
+            trim(keptBytes());
+        }
+        return iter->pixmap;
+    }
+    void setLimit(qint64 bytes) {
+        this->limit_bytes = bytes;
+        trim(keptBytes());
+    }
+    [[nodiscard]] qint64 limit() const { return this->limit_bytes; }
+    // bytes of the scaled entries, held or not
+    [[nodiscard]] qint64 usedBytes() const { return this->used_bytes; }
+
+ private:
+    static qint64 BytesOf(const QPixmap &pixmap) {
+        return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    }
+    // once the application quits, entries are dropped as soon as no widget holds them
+    [[nodiscard]] qint64 keptBytes() const { return this->quitting ? 0 : this->limit_bytes; }
+    void trim(qint64 limit) {
+        // entries are few, one per distinct image and size on screen, a scan is cheaper than keeping an order
+        while (this->used_bytes > limit) {
+            auto oldest = this->entries.end();
+            for (auto iter = this->entries.begin(); iter != this->entries.end(); ++iter) {
+                if (iter->users->loadAcquire() != 0 || iter->pixmap.isNull()) continue;
+                if (oldest == this->entries.end() || iter->last_use < oldest->last_use) oldest = iter;
+            }
+            // the rest are held by widgets
+            if (oldest == this->entries.end()) return;
+            this->used_bytes -= BytesOf(oldest->pixmap);
+            this->entries.erase(oldest);
+        }
+    }
+
+ private:
+    QHash<QtScaledImageKey_t, Entry_t> entries;
+    qint64 used_bytes = 0; // of scaled entries, held or not
+    qint64 limit_bytes = kDefaultSharedCacheLimit;
+    quint64 tick = 0;
+    bool quit_watched = false;
+    bool quitting = false;
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTIMAGECACHE_P_H_
@@ -0,0 +1,136 @@
+#include "qtimagetiles_p.h"
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+QtImageTiles::QtImageTiles(const QString &file_name, const QSize &size, bool clip, QObject *context,
+                           std::function<void()> loaded)
+    : file_name(file_name), image_size(size), context(context), loaded(std::move(loaded)) {
+    while (this->level_count < 31) {
+        auto level = levelSize(this->level_count - 1);
+        if (level.width() <= kTileSize && level.height() <= kTileSize) break;
+        ++this->level_count;
+    }
+    // a full decode per tile takes the memory of the whole image, they are not run in parallel
+    this->max_loading = clip ? std::max(1, QThreadPool::globalInstance()->maxThreadCount()) : 1;
+    setLimit(kDefaultLimit);
+}
+
+QSize QtImageTiles::levelSize(int level) const {
+    auto factor = 1 << level;
+    return {(this->image_size.width() + factor - 1) / factor, (this->image_size.height() + factor - 1) / factor};
+}
+
+int QtImageTiles::levelFor(qreal scale) const {
+    if (scale <= 0) return this->level_count - 1;
+    if (scale >= 1) return 0;
+    // the level is downscaled when painted, never upscaled
+    return qBound(0, int(std::floor(std::log2(1.0 / scale))), this->level_count - 1);
+}
+
+QVector<QtImageTileKey_t> QtImageTiles::tilesIn(int level, const QRectF &rect) const {
+    auto factor = qreal(1 << level);
+    auto level_size = levelSize(level);
+    auto area = QRectF(rect.topLeft() / factor, rect.size() / factor) & QRectF(QPointF(0, 0), QSizeF(level_size));
+    if (area.isEmpty()) return {};
+    auto left = int(std::floor(area.left() / kTileSize));
+    auto top = int(std::floor(area.top() / kTileSize));
+    auto right = std::min(int(std::ceil(area.right() / kTileSize)), (level_size.width() + kTileSize - 1) / kTileSize);
+    auto bottom = std::min(int(std::ceil(area.bottom() / kTileSize)), (level_size.height() + kTileSize - 1) / kTileSize);
+    QVector<QtImageTileKey_t> keys;
+    keys.reserve((right - left) * (bottom - top));
+    for (int y = top; y < bottom; ++y) {
+        for (int x = left; x < right; ++x) keys.append({level, x, y});
+    }
+    // the center of the view is loaded first
+    auto center = area.center() / kTileSize;
+    std::sort(keys.begin(), keys.end(), [center](const QtImageTileKey_t &a, const QtImageTileKey_t &b) {
+        auto da = QPointF(a.x + 0.5, a.y + 0.5) - center;
+        auto db = QPointF(b.x + 0.5, b.y + 0.5) - center;
+        return QPointF::dotProduct(da, da) < QPointF::dotProduct(db, db);
+    });
+    return keys;
+}
+
+QRectF QtImageTiles::imageRect(const QtImageTileKey_t &key) const {
+    auto factor = qreal(1 << key.level);
+    auto tile = QRect(key.x * kTileSize, key.y * kTileSize, kTileSize, kTileSize) & QRect(QPoint(0, 0), levelSize(key.level));
+    return QRectF(tile.x() * factor, tile.y() * factor, tile.width() * factor, tile.height() * factor)
+        & QRectF(QPointF(0, 0), QSizeF(this->image_size));
+}
+
+QImage QtImageTiles::find(const QtImageTileKey_t &key) {
+    auto image = this->tiles.object(key);
+    return image ? *image : QImage();
+}
+
+void QtImageTiles::request(const QVector<QtImageTileKey_t> &keys) {
+    this->queue.clear();
+    QSet<QtImageTileKey_t> queued;
+    for (auto const &key : keys) {
+        if (this->tiles.contains(key) || this->loading.contains(key) || this->failed.contains(key)) continue;
+        if (queued.contains(key)) continue;
+        queued.insert(key);
+        this->queue.append(key);
+    }
+    loadNext();
+}
+
+void QtImageTiles::setLimit(qint64 bytes) {
+    this->tiles.setMaxCost(int(qBound<qint64>(1, bytes / 1024, INT_MAX)));
+}
+
+qint64 QtImageTiles::limit() const {
+    return qint64(this->tiles.maxCost()) * 1024;
+}
+
+void QtImageTiles::loadNext() {
+    // a few tiles are loaded at a time, so a changed request is served without waiting for stale tiles
+    while (this->loading.size() < this->max_loading && !this->queue.isEmpty() && this->context) {
+        auto key = this->queue.takeFirst();
+        this->loading.insert(key);
+        auto source = this->imageRect(key).toAlignedRect() & QRect(QPoint(0, 0), this->image_size);
+        auto size = QRect(key.x * kTileSize, key.y * kTileSize, kTileSize, kTileSize).intersected(
+            QRect(QPoint(0, 0), levelSize(key.level))).size();
+        // the watcher is destroyed with the context, so no tile is delivered to a destroyed widget
+        auto watcher = new QFutureWatcher<QImage>(this->context);
+        QWeakPointer<QtImageTiles> weak = sharedFromThis();
+        QObject::connect(watcher, &QFutureWatcher<QImage>::finished, this->context, [weak, watcher, key] {
+            if (auto tiles = weak.toStrongRef()) tiles->finish(key, watcher->result());
+            watcher->deleteLater();
+        });
+        auto file_name = this->file_name;
+        watcher->setFuture(QtConcurrent::run([file_name, source, size] {
+            QImageReader reader(file_name);
+            reader.setClipRect(source);
+            reader.setScaledSize(size);
+            auto image = reader.read();
+            if (image.isNull()) {
+                qWarning("[QtImageWidget] Cannot decode tile of image: %s, error: %s",
+                         qUtf8Printable(file_name), qUtf8Printable(reader.errorString()));
+                return image;
+            }
+            // the raster engine draws premultiplied images without converting them
+            return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        }));
+    }
+}
+
+void QtImageTiles::finish(const QtImageTileKey_t &key, const QImage &image) {
+    this->loading.remove(key);
+    if (image.isNull()) {
+        this->failed.insert(key);
+    } else {
+        this->tiles.insert(key, new QImage(image), int(std::max<qint64>(1, image.sizeInBytes() / 1024)));
+    }
+    loadNext();
+    if (!image.isNull() && this->loaded) this->loaded();
+}
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
@@ -0,0 +1,111 @@
+#ifndef QTWIDGETS_SRC_QTIMAGETILES_P_H_
+#define QTWIDGETS_SRC_QTIMAGETILES_P_H_
+
+#include "namespace.h"
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QPointer>
+#include <QRectF>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
+
+/**
+ * @brief key of a tile, x and y are the column and the row in the level
+ */
+struct QtImageTileKey_t {
+    int level = 0;
+    int x = 0;
+    int y = 0;
+};
+
+inline bool operator==(const QtImageTileKey_t &a, const QtImageTileKey_t &b) {
+    return a.level == b.level && a.x == b.x && a.y == b.y;
+}
+
+inline uint qHash(const QtImageTileKey_t &key, uint seed = 0) {
+    return ::qHash((quint64(quint32(key.x)) << 32) | quint32(key.y), seed) ^ ::qHash(key.level, seed);
+}
+
+/**
+ * @brief tiles of an image file which is too large to be decoded at once, it is used in the gui thread only.
+ *
+ * level 0 is the image at full resolution, each level is half the size of the previous one, the last level
+ * fits in one tile. tiles are decoded on request in the global thread pool by QImageReader with a clip rect
+ * and a scaled size, so formats the reader decodes regions of natively (jpeg) are read partially,
+ * and decoded tiles are kept in a least recently used cache within the memory limit.
+ * other formats are decoded whole for each tile, so only one tile is decoded at a time for them.
+ */
+class QtImageTiles : public QEnableSharedFromThis<QtImageTiles> {
+ public:
+    static constexpr int kTileSize = 256;
+    static constexpr qint64 kDefaultLimit = 128 * 1024 * 1024;
+
+ public:
+    /**
+     * @param [in] file_name image file, it is read again for each tile
+     * @param [in] size image size
+     * @param [in] clip whether the reader decodes regions of the file natively
+     * @param [in] context loaded tiles are delivered in its thread, nothing is delivered after it is destroyed
+     * @param [in] loaded called in the gui thread when a tile is loaded
+     */
+    QtImageTiles(const QString &file_name, const QSize &size, bool clip, QObject *context,
+                 std::function<void()> loaded);
+
+ public:
+    [[nodiscard]] QSize size() const { return this->image_size; }
+    [[nodiscard]] int levelCount() const { return this->level_count; }
+    /**
+     * @brief get the finest level which is not finer than needed
+     * @param [in] scale device pixels per image pixel
+     */
+    [[nodiscard]] int levelFor(qreal scale) const;
+    /**
+     * @brief get tiles of level intersecting rect, the nearest to the center of rect first
+     * @param [in] rect area in image pixels
+     */
+    [[nodiscard]] QVector<QtImageTileKey_t> tilesIn(int level, const QRectF &rect) const;
+    /**
+     * @brief get the area of the tile in image pixels
+     */
+    [[nodiscard]] QRectF imageRect(const QtImageTileKey_t &key) const;
+    /**
+     * @brief get a loaded tile and mark it as recently used, null if it is not loaded
+     */
+    [[nodiscard]] QImage find(const QtImageTileKey_t &key);
+    /**
+     * @brief replace the tiles waiting to be loaded, tiles are loaded in the order given.
+     *        queued tiles which are not wanted any more are dropped, running loads are finished
+     */
+    void request(const QVector<QtImageTileKey_t> &keys);
+    void setLimit(qint64 bytes);
+    [[nodiscard]] qint64 limit() const;
+
+ private:
+    [[nodiscard]] QSize levelSize(int level) const;
+    void loadNext();
+    void finish(const QtImageTileKey_t &key, const QImage &image);
+
+ private:
+    QString file_name;
+    QSize image_size;
+    int level_count = 1;
+    QPointer<QObject> context;
+    std::function<void()> loaded;
+    QCache<QtImageTileKey_t, QImage> tiles; // cost in KiB
+    QVector<QtImageTileKey_t> queue;
+    QSet<QtImageTileKey_t> loading;
+    QSet<QtImageTileKey_t> failed; // not requested again
+    int max_loading = 1; // tiles decoded at a time
+};
+
+FNRICE_QT_WIDGETS_END_NAMESPACE
+
+#endif //QTWIDGETS_SRC_QTIMAGETILES_P_H_
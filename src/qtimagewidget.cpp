@@ -1,9 +1,20 @@
 #include "qtimagewidget.h"
+#include "qtimagecache_p.h"
+#include "qtimagetiles_p.h"
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QMutex>
 #include <QPainter>
 #include <QPaintEvent>
+#include <QtConcurrent>
+#include <cmath>
 
 FNRICE_QT_WIDGETS_BEGIN_NAMESPACE
 
+static auto constexpr kSyncScalePixels = 512 * 512; // smaller images are scaled smoothly in place
+
 class QtImageWidgetPrivate {
  public:
     explicit QtImageWidgetPrivate(QtImageWidget *q) : q_ptr(q) {}
@@ -29,10 +40,41 @@ class QtImageWidgetPrivate {
     QSize image_size;
     QPoint image_pos;
 
+    // with an image source, pixmap is the source decoded at the largest size needed so far
+    bool has_source = false;
+    QString source_file;
+    QByteArray source_data; // encoded bytes if the source is a device
+    QSize source_size; // invalid if the reader cannot tell it without decoding
+
+    // large images are scaled smoothly in the global thread pool, a fast preview is painted meanwhile
+    QSharedPointer<QtImagePyramid> pyramid; // of pixmap, created on first use and shared with scaling jobs
+    qint64 pyramid_limit = kDefaultPyramidLimit;
+    QSharedPointer<QAtomicInteger<quint64>> generation{new QAtomicInteger<quint64>(0)}; // bumped per job
+    QFutureWatcher<QImage> *watcher = nullptr;
+    quint64 job_generation = 0; // generation of the watched job
+    bool job_decodes = false; // the watched job decodes the source instead of scaling pixmap
+    // scaled_pixmap is shared with other widgets showing the same pixmap at the same size
+    QtScaledImageKey_t cache_key{};
+    bool cache_held = false;
+
+    // in tiled mode, the image is placed by zoom and pan instead of the image properties
+    QSharedPointer<QtImageTiles> tiles;
+    qreal zoom = 1.0;
+    QPointF pan; // image position at the widget center
+    QPointF pan_motion; // last pan step, tiles ahead of it are prefetched
+    qreal zoom_motion = 1.0; // last zoom ratio
+    qint64 tile_limit = QtImageTiles::kDefaultLimit;
+
  public:
     QSize calculateMinimumSize();
     QSize calculateMaximumSize();
     QSize calculatePixmapSize();
+    void scalePixmap();
+    void setSource(const QSize &size);
+    void decodeSource(quint64 current);
+    void watch(const QFuture<QImage> &future, quint64 current, bool decodes);
+    void releaseCached();
+    void paintTiles(QPainter *painter);
 
  private:
     Q_DECLARE_PUBLIC(QtImageWidget);
@@ -50,12 +92,23 @@ QtImageWidget::QtImageWidget(const QPixmap &pixmap, QWidget *parent)
 }
 
 QtImageWidget::~QtImageWidget() {
+    Q_D(QtImageWidget);
+    // a running job finds itself stale and returns early, its result is dropped with the watcher
+    d->generation->fetchAndAddOrdered(1);
+    d->releaseCached();
     delete d_ptr;
 }
 
 void QtImageWidget::setPixmap(const QPixmap &pixmap) {
     Q_D(QtImageWidget);
+    d->tiles.reset();
+    d->has_source = false;
+    d->source_file.clear();
+    d->source_data.clear();
     d->pixmap = pixmap;
+    d->pyramid.reset();
+    d->releaseCached();
+    d->generation->fetchAndAddOrdered(1);
     d->pixmap_changed = true;
     QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
 }
@@ -65,6 +118,79 @@ QPixmap QtImageWidget::pixmap() const {
     return d->pixmap;
 }
 
+bool QtImageWidget::setImageSource(const QString &file_name) {
+    Q_D(QtImageWidget);
+    // only the header is read here
+    QImageReader reader(file_name);
+    if (!reader.canRead()) return false;
+    d->source_file = file_name;
+    d->source_data.clear();
+    d->setSource(reader.size());
+    return true;
+}
+
+bool QtImageWidget::setImageSource(QIODevice *device) {
+    Q_D(QtImageWidget);
+    if (!device || !device->isReadable()) return false;
+    auto data = device->readAll();
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    if (!reader.canRead()) return false;
+    d->source_file.clear();
+    d->source_data = data;
+    d->setSource(reader.size());
+    return true;
+}
+
+bool QtImageWidget::setTiledImageSource(const QString &file_name) {
+    Q_D(QtImageWidget);
+    QImageReader reader(file_name);
+    auto size = reader.size();
+    // tiles are laid out before anything is decoded
+    if (!reader.canRead() || !size.isValid()) return false;
+    auto clip = reader.supportsOption(QImageIOHandler::ClipRect);
+    if (!clip) {
+        // the whole image is decoded for each tile, the reader refuses images beyond its allocation limit
+        auto limit = qint64(QImageReader::allocationLimit()) * 1024 * 1024;
+        if (limit > 0 && qint64(size.width()) * size.height() * 4 > limit) {
+            qWarning("[QtImageWidget] Cannot tile image: %s, its format cannot be decoded partially and it exceeds "
+                     "the allocation limit of QImageReader", qUtf8Printable(file_name));
+            return false;
+        }
+        qWarning("[QtImageWidget] Image format cannot be decoded partially, each tile decodes the whole image: %s",
+                 qUtf8Printable(file_name));
+    }
+    setPixmap(QPixmap());
+    d->tiles.reset(new QtImageTiles(file_name, size, clip, this, [this] { update(); }));
+    d->tiles->setLimit(d->tile_limit);
+    d->pan = QPointF(size.width() / 2.0, size.height() / 2.0);
+    d->pan_motion = QPointF();
+    d->zoom_motion = 1.0;
+    return true;
+}
+
+QSize QtImageWidget::imageSourceSize() const {
+    Q_D(const QtImageWidget);
+    if (d->tiles) return d->tiles->size();
+    if (d->has_source) return d->source_size;
+    return d->pixmap.size();
+}
+
+void QtImageWidgetPrivate::setSource(const QSize &size) {
+    Q_Q(QtImageWidget);
+    this->tiles.reset();
+    this->has_source = true;
+    this->source_size = size;
+    this->pixmap = QPixmap();
+    this->scaled_pixmap = QPixmap();
+    this->pyramid.reset();
+    releaseCached();
+    this->generation->fetchAndAddOrdered(1);
+    this->pixmap_changed = true;
+    QMetaObject::invokeMethod(q, qOverload<>(&QWidget::update));
+}
+
 void QtImageWidget::setBorderWidth(int width) {
     Q_D(QtImageWidget);
     d->border_width = width;
@@ -168,6 +294,61 @@ int QtImageWidget::imageMaximumPercent() const {
     return d->maximum_percent;
 }
 
+void QtImageWidget::setImagePyramidLimit(qint64 bytes) {
+    Q_D(QtImageWidget);
+    d->pyramid_limit = bytes;
+    // takes effect from the next pixmap, the current levels are kept
+}
+
+qint64 QtImageWidget::imagePyramidLimit() const {
+    Q_D(const QtImageWidget);
+    return d->pyramid_limit;
+}
+
+void QtImageWidget::setSharedCacheLimit(qint64 bytes) {
+    QtScaledImageCache::Instance().setLimit(bytes);
+}
+
+qint64 QtImageWidget::sharedCacheLimit() {
+    return QtScaledImageCache::Instance().limit();
+}
+
+void QtImageWidget::setImageZoom(qreal zoom) {
+    Q_D(QtImageWidget);
+    if (zoom <= 0) return;
+    d->zoom_motion = zoom / d->zoom;
+    d->zoom = zoom;
+    QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
+}
+
+qreal QtImageWidget::imageZoom() const {
+    Q_D(const QtImageWidget);
+    return d->zoom;
+}
+
+void QtImageWidget::setImagePan(const QPointF &pos) {
+    Q_D(QtImageWidget);
+    d->pan_motion = pos - d->pan;
+    d->pan = pos;
+    QMetaObject::invokeMethod(this, qOverload<>(&QWidget::update));
+}
+
+QPointF QtImageWidget::imagePan() const {
+    Q_D(const QtImageWidget);
+    return d->pan;
+}
+
+void QtImageWidget::setTileMemoryLimit(qint64 bytes) {
+    Q_D(QtImageWidget);
+    d->tile_limit = bytes;
+    if (d->tiles) d->tiles->setLimit(bytes);
+}
+
+qint64 QtImageWidget::tileMemoryLimit() const {
+    Q_D(const QtImageWidget);
+    return d->tile_limit;
+}
+
 void QtImageWidget::setImageMargins(int left, int right, int top, int bottom) {
     Q_D(QtImageWidget);
     d->margins[0] = left;
@@ -208,7 +389,11 @@ void QtImageWidget::paintEvent(QPaintEvent *event) {
     // ------ draw background end ------
 
     // ------ draw pixmap begin ------
-    if (d->pixmap.isNull()) { return; } // draw nothing
+    if (d->tiles) {
+        d->paintTiles(&painter);
+        return;
+    }
+    if (d->pixmap.isNull() && !d->has_source) { return; } // draw nothing
     bool regen_pixmap = false;
     bool regen_pos = false;
     if (d->size_changed) {
@@ -230,7 +415,7 @@ void QtImageWidget::paintEvent(QPaintEvent *event) {
         d->align_changed = false;
     }
     if (regen_pixmap) {
-        d->scaled_pixmap = d->pixmap.scaled(d->image_size, this->imageAspectRatioMode());
+        d->scalePixmap();
     }
     if (regen_pos) {
         int x = 0, y = 0;
@@ -255,6 +440,190 @@ void QtImageWidget::paintEvent(QPaintEvent *event) {
     // ------ draw pixmap end ------
 }
 
+void QtImageWidgetPrivate::scalePixmap() {
+    auto current = this->generation->fetchAndAddOrdered(1) + 1;
+    auto mode = this->image_aspect_ratio_mode;
+    releaseCached();
+    if (this->has_source) {
+        // decoding never upscales, a source smaller than the target is scaled up like a pixmap
+        auto size = this->source_size.isValid()
+                        ? this->source_size.scaled(this->image_size, mode).boundedTo(this->source_size) : QSize();
+        auto covered = !this->pixmap.isNull() && (!size.isValid()
+            || (this->pixmap.width() >= size.width() && this->pixmap.height() >= size.height()));
+        if (!covered) {
+            decodeSource(current);
+            return;
+        }
+    }
+    if (this->pixmap.size().scaled(this->image_size, mode) == this->pixmap.size()) {
+        this->scaled_pixmap = this->pixmap;
+        return;
+    }
+    auto &cache = QtScaledImageCache::Instance();
+    this->cache_key = {this->pixmap.cacheKey(), this->image_size, mode, this->pixmap.devicePixelRatioF()};
+    this->cache_held = true;
+    auto entry = cache.acquire(this->cache_key);
+    if (!entry->pixmap.isNull()) {
+        this->scaled_pixmap = entry->pixmap;
+        return;
+    }
+    if (qint64(this->pixmap.width()) * this->pixmap.height() <= kSyncScalePixels) {
+        this->scaled_pixmap = cache.store(this->cache_key,
+                                          this->pixmap.scaled(this->image_size, mode, Qt::SmoothTransformation));
+        return;
+    }
+    // nearest neighbour sampling touches only the target pixels, it is cheap enough for every resize
+    this->scaled_pixmap = this->pixmap.scaled(this->image_size, mode, Qt::FastTransformation);
+    if (!entry->scaling) {
+        if (!this->pyramid) this->pyramid.reset(new QtImagePyramid(this->pixmap.toImage(), this->pyramid_limit));
+        // jobs which nobody waits for when they start are skipped
+        auto pyramid = this->pyramid;
+        auto size = this->image_size;
+        auto target = this->pixmap.size().scaled(size, mode);
+        auto users = entry->users;
+        entry->job = QtConcurrent::run([pyramid, size, target, mode, users] {
+            if (users->loadAcquire() == 0) return QImage();
+            // the cost depends on the target size, not on the source size
+            return pyramid->levelFor(target).scaled(size, mode, Qt::SmoothTransformation);
+        });
+        entry->scaling = true;
+    }
+    // widgets waiting for the same entry watch the same job
+    watch(entry->job, current, false);
+}
+
+void QtImageWidgetPrivate::paintTiles(QPainter *painter) {
+    Q_Q(QtImageWidget);
+    auto view_size = QSizeF(q->size()) / this->zoom;
+    auto view = QRectF(this->pan - QPointF(view_size.width(), view_size.height()) / 2, view_size);
+    auto level = this->tiles->levelFor(this->zoom * q->devicePixelRatioF());
+    auto top = this->tiles->levelCount() - 1;
+    // tiles are stretched to whole pixels, so there are no seams between them
+    auto map = [this, &view](const QRectF &rect) {
+        return QRectF(QRectF((rect.topLeft() - view.topLeft()) * this->zoom, rect.size() * this->zoom).toAlignedRect());
+    };
+    auto visible = this->tiles->tilesIn(level, view);
+    for (auto const &key : visible) {
+        auto rect = this->tiles->imageRect(key);
+        auto tile = this->tiles->find(key);
+        if (!tile.isNull()) {
+            painter->drawImage(map(rect), tile);
+            continue;
+        }
+        // a coarser tile stands in until the tile is loaded
+        for (auto coarse = key; coarse.level < top;) {
+            coarse = {coarse.level + 1, coarse.x / 2, coarse.y / 2};
+            auto image = this->tiles->find(coarse);
+            if (image.isNull()) continue;
+            auto coarse_rect = this->tiles->imageRect(coarse);
+            auto sx = image.width() / coarse_rect.width();
+            auto sy = image.height() / coarse_rect.height();
+            QRectF source((rect.x() - coarse_rect.x()) * sx, (rect.y() - coarse_rect.y()) * sy,
+                          rect.width() * sx, rect.height() * sy);
+            painter->drawImage(map(rect), image, source);
+            break;
+        }
+    }
+
+    // the coarsest level is loaded first as the fallback of every tile,
+    // then the view, then the area ahead of the motion
+    auto wanted = this->tiles->tilesIn(top, QRectF(QPointF(0, 0), QSizeF(this->tiles->size())));
+    wanted += visible;
+    auto step = std::max(std::abs(this->pan_motion.x()), std::abs(this->pan_motion.y()));
+    if (step > 0) {
+        auto ahead = view.translated(this->pan_motion.x() / step * view.width() / 2,
+                                     this->pan_motion.y() / step * view.height() / 2);
+        wanted += this->tiles->tilesIn(level, ahead);
+    }
+    if (this->zoom_motion > 1 && level > 0) {
+        // zooming in shows the center of the view at the finer level next
+        wanted += this->tiles->tilesIn(level - 1, QRectF(view.center() - QPointF(view.width(), view.height()) / 4,
+                                                         view.size() / 2));
+    } else if (this->zoom_motion < 1 && level < top) {
+        wanted += this->tiles->tilesIn(level + 1, QRectF(view.center() - QPointF(view.width(), view.height()),
+                                                         view.size() * 2));
+    }
+    this->tiles->request(wanted);
+    // a motion is followed once, later paints prefetch around the view only
+    this->pan_motion = QPointF();
+    this->zoom_motion = 1.0;
+}
+
+void QtImageWidgetPrivate::releaseCached() {
+    if (!this->cache_held) return;
+    this->cache_held = false;
+    QtScaledImageCache::Instance().release(this->cache_key);
+}
+
+void QtImageWidgetPrivate::decodeSource(quint64 current) {
+    auto mode = this->image_aspect_ratio_mode;
+    auto size = this->source_size.isValid()
+                    ? this->source_size.scaled(this->image_size, mode).boundedTo(this->source_size) : QSize();
+    if (size.isValid() && size.isEmpty()) {
+        this->scaled_pixmap = QPixmap();
+        return;
+    }
+    // the smaller decoded image is stretched until the larger one arrives
+    this->scaled_pixmap = this->pixmap.isNull()
+                              ? QPixmap() : this->pixmap.scaled(this->image_size, mode, Qt::FastTransformation);
+    auto file_name = this->source_file;
+    auto data = this->source_data;
+    auto generation = this->generation;
+    watch(QtConcurrent::run([file_name, data, size, generation, current] {
+        if (generation->loadAcquire() != current) return QImage();
+        QBuffer buffer;
+        QImageReader reader;
+        if (file_name.isEmpty()) {
+            buffer.setData(data);
+            buffer.open(QIODevice::ReadOnly);
+            reader.setDevice(&buffer);
+        } else {
+            reader.setFileName(file_name);
+        }
+        // jpeg is decoded at a reduced scale directly, other formats are decoded and scaled by the reader
+        if (size.isValid()) reader.setScaledSize(size);
+        auto image = reader.read();
+        if (image.isNull()) {
+            qWarning("[QtImageWidget] Cannot decode image: %s, error: %s",
+                     qUtf8Printable(file_name), qUtf8Printable(reader.errorString()));
+        }
+        return image;
+    }), current, true);
+}
+
+void QtImageWidgetPrivate::watch(const QFuture<QImage> &future, quint64 current, bool decodes) {
+    Q_Q(QtImageWidget);
+    if (!this->watcher) {
+        this->watcher = new QFutureWatcher<QImage>(q);
+        QObject::connect(this->watcher, &QFutureWatcher<QImage>::finished, q, [this] {
+            Q_Q(QtImageWidget);
+            // a newer size or pixmap arrived meanwhile, the result is stale
+            if (this->generation->loadAcquire() != this->job_generation) return;
+            auto result = this->watcher->result();
+            if (result.isNull()) return;
+            if (this->job_decodes) {
+                // the decoded image covers the target now, it is scaled like a pixmap
+                this->pixmap = QPixmap::fromImage(result);
+                this->pyramid.reset();
+                scalePixmap();
+            } else {
+                // the first widget to finish converts the result, the others get the same pixmap
+                auto &cache = QtScaledImageCache::Instance();
+                this->scaled_pixmap = cache.find(this->cache_key);
+                if (this->scaled_pixmap.isNull()) {
+                    this->scaled_pixmap = cache.store(this->cache_key, QPixmap::fromImage(result));
+                }
+            }
+            this->align_changed = true;
+            q->update();
+        });
+    }
+    // the watcher only reports the latest job
+    this->job_generation = current;
+    this->job_decodes = decodes;
+    this->watcher->setFuture(future);
+}
+
 QSize QtImageWidgetPrivate::calculateMinimumSize() {
     Q_Q(const QtImageWidget);
     if (this->minimum_pixel_size.isValid()) {
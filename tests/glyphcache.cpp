@@ -0,0 +1,92 @@
+#include <QCoreApplication>
+#include <QImage>
+#include "../src/qticonfont_p.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static QImage Glyph(int size) {
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    return image;
+}
+
+static QtGlyphKey_t Key(uint32_t codepoint, int pixel_size = 16) {
+    return {codepoint, pixel_size, qRgba(0, 0, 0, 255), 1.0};
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+    auto const glyph_bytes = Glyph(16).sizeInBytes();
+    CHECK(glyph_bytes == 16 * 16 * 4);
+
+    QtGlyphCache<QImage> cache;
+    cache.setLimit(3 * glyph_bytes);
+    CHECK(cache.limit() == 3 * glyph_bytes);
+
+    // ------ fill up to the budget, nothing is evicted
+    for (uint32_t code = 1; code <= 3; ++code) cache.insert(Key(code), Glyph(16));
+    auto stats = cache.stats();
+    CHECK(stats.count == 3);
+    CHECK(stats.bytes == 3 * glyph_bytes);
+    CHECK(stats.evictions == 0);
+
+    // ------ the least recently used entry is evicted first, lookups refresh entries
+    CHECK(!cache.find(Key(1)).isNull());
+    cache.insert(Key(4), Glyph(16));
+    CHECK(cache.find(Key(2)).isNull());
+    CHECK(!cache.find(Key(1)).isNull());
+    CHECK(!cache.find(Key(3)).isNull());
+    CHECK(!cache.find(Key(4)).isNull());
+    stats = cache.stats();
+    CHECK(stats.count == 3);
+    CHECK(stats.bytes == 3 * glyph_bytes);
+    CHECK(stats.evictions == 1);
+    CHECK(stats.hits == 4);
+    CHECK(stats.misses == 1);
+
+    // ------ keys differ by size and color
+    CHECK(cache.find(Key(1, 32)).isNull());
+    CHECK(cache.find({1, 16, qRgba(255, 0, 0, 255), 1.0}).isNull());
+
+    // ------ a large entry evicts as many entries as needed, in lru order
+    cache.insert(Key(5), Glyph(26)); // 2.6 glyphs of bytes
+    stats = cache.stats();
+    CHECK(stats.bytes <= cache.limit());
+    CHECK(stats.count == 1);
+    CHECK(!cache.find(Key(5)).isNull());
+
+    // ------ an entry larger than the budget is not cached and evicts nothing
+    cache.insert(Key(6), Glyph(64));
+    CHECK(cache.find(Key(6)).isNull());
+    CHECK(!cache.find(Key(5)).isNull());
+
+    // ------ replacing an entry replaces its cost
+    cache.clear();
+    cache.insert(Key(1), Glyph(16));
+    cache.insert(Key(1), Glyph(8));
+    CHECK(cache.stats().count == 1);
+    CHECK(cache.stats().bytes == Glyph(8).sizeInBytes());
+
+    // ------ lowering the budget trims least recently used entries
+    cache.clear();
+    for (uint32_t code = 1; code <= 3; ++code) cache.insert(Key(code), Glyph(16));
+    CHECK(!cache.find(Key(1)).isNull());
+    cache.setLimit(glyph_bytes);
+    CHECK(cache.stats().count == 1);
+    CHECK(!cache.find(Key(1)).isNull());
+    cache.setLimit(0);
+    CHECK(cache.stats().count == 0);
+    CHECK(cache.stats().bytes == 0);
+    cache.insert(Key(1), Glyph(16));
+    CHECK(cache.stats().count == 0);
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+#include <cstring>
+#include <functional>
+#include "../src/qtglyphdiskcache_p.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static QImage Mask(int width, int height, int seed) {
+    QImage mask(width, height, QImage::Format_Alpha8);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) mask.scanLine(y)[x] = uchar(x * 7 + y * 13 + seed);
+    }
+    return mask;
+}
+
+static bool SamePixels(const QImage &a, const QImage &b) {
+    if (a.size() != b.size() || a.format() != b.format()) return false;
+    for (int y = 0; y < a.height(); ++y) {
+        if (std::memcmp(a.constScanLine(y), b.constScanLine(y), size_t(a.width())) != 0) return false;
+    }
+    return true;
+}
+
+static QStringList Packs(const QString &directory) {
+    return QDir(directory).entryList({"*.qifc"}, QDir::Files, QDir::Name);
+}
+
+static bool Rewrite(const QString &path, const std::function<void(QByteArray *)> &change) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    auto data = file.readAll();
+    file.close();
+    change(&data);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return file.write(data) == data.size();
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    auto directory = dir.filePath("cache");
+    const QtGlyphKey_t key_a{0xE001, 16, 0, 1.0}, key_b{0xE002, 24, 0, 2.0};
+    // odd widths, so rows are padded in the pack
+    auto mask_a = Mask(13, 16, 1), mask_b = Mask(47, 48, 2);
+    mask_b.setDevicePixelRatio(2.0);
+
+    // ------ round trip
+    {
+        QtGlyphDiskCache cache;
+        CHECK(cache.open(directory, "source-a", 1));
+        CHECK(cache.find(key_a).isNull());
+        cache.insert(key_a, mask_a);
+        cache.insert(key_b, mask_b);
+        cache.insert({0xE003, 16, 0, 1.0}, QImage(4, 4, QImage::Format_ARGB32)); // not an alpha mask
+        CHECK(cache.pendingBytes() == mask_a.sizeInBytes() + mask_b.sizeInBytes());
+        CHECK(SamePixels(cache.find(key_a), mask_a));
+        CHECK(cache.save());
+        CHECK(cache.pendingBytes() == 0);
+        CHECK(Packs(directory).size() == 1);
+    }
+    {
+        QtGlyphDiskCache cache;
+        CHECK(cache.open(directory, "source-a", 1));
+        {
+            auto found_a = cache.find(key_a), found_b = cache.find(key_b);
+            CHECK(SamePixels(found_a, mask_a));
+            CHECK(SamePixels(found_b, mask_b));
+            CHECK(found_b.devicePixelRatio() == 2.0);
+            CHECK(cache.find({0xE003, 16, 0, 1.0}).isNull());
+            CHECK(cache.find({0xE001, 17, 0, 1.0}).isNull());
+            CHECK(cache.hits() == 2);
+        }
+        // nothing new, the pack is not written again
+        CHECK(cache.save());
+    }
+
+    // ------ other content of the same source replaces the pack, other sources keep theirs
+    auto pack_a = Packs(directory).first();
+    {
+        QtGlyphDiskCache cache;
+        CHECK(cache.open(directory, "source-a", 2));
+        CHECK(cache.find(key_a).isNull());
+        cache.insert(key_a, mask_a);
+        CHECK(cache.save());
+        CHECK(Packs(directory).size() == 1);
+        CHECK(Packs(directory).first() != pack_a);
+    }
+    {
+        QtGlyphDiskCache same_name, unknown_source;
+        CHECK(same_name.open(directory, "source-b", 3));
+        same_name.insert(key_a, mask_a);
+        CHECK(same_name.save());
+        CHECK(unknown_source.open(directory, QString(), 4));
+        unknown_source.insert(key_a, mask_a);
+        CHECK(unknown_source.save());
+        CHECK(Packs(directory).size() == 3);
+    }
+
+    // ------ corrupt packs are rejected and replaced on save
+    QDir(directory).removeRecursively();
+    {
+        QtGlyphDiskCache cache;
+        CHECK(cache.open(directory, "source-a", 5));
+        cache.insert(key_a, mask_a);
+        cache.insert(key_b, mask_b);
+        CHECK(cache.save());
+    }
+    auto pack = QDir(directory).filePath(Packs(directory).first());
+    QFile file(pack);
+    CHECK(file.open(QIODevice::ReadOnly));
+    auto original = file.readAll();
+    file.close();
+    QtGlyphDiskCache::Header_t header{};
+    std::memcpy(&header, original.constData(), sizeof(header));
+
+    auto restore = [&original](QByteArray *data) { *data = original; };
+    const QVector<std::function<void(QByteArray *)>> corruptions = {
+        [](QByteArray *data) { data->truncate(int(sizeof(QtGlyphDiskCache::Header_t)) - 1); },
+        [](QByteArray *data) { (*data)[0] = 'X'; },
+        [](QByteArray *data) { reinterpret_cast<QtGlyphDiskCache::Header_t *>(data->data())->qt_version ^= 1; },
+        [](QByteArray *data) { reinterpret_cast<QtGlyphDiskCache::Header_t *>(data->data())->content_hash = 6; },
+        [](QByteArray *data) { reinterpret_cast<QtGlyphDiskCache::Header_t *>(data->data())->count += 1; },
+        [](QByteArray *data) { reinterpret_cast<QtGlyphDiskCache::Header_t *>(data->data())->index_offset = ~0ull; },
+        [header](QByteArray *data) {
+            // a glyph pointing past the pixels
+            QtGlyphDiskCache::Record_t record{};
+            std::memcpy(&record, data->constData() + header.index_offset, sizeof(record));
+            record.offset = header.index_offset;
+            std::memcpy(data->data() + header.index_offset, &record, sizeof(record));
+        },
+        [header](QByteArray *data) { data->truncate(int(header.index_offset + sizeof(QtGlyphDiskCache::Record_t))); },
+    };
+    for (auto const &corrupt : corruptions) {
+        CHECK(Rewrite(pack, corrupt));
+        QtGlyphDiskCache cache;
+        CHECK(cache.open(directory, "source-a", 5));
+        CHECK(cache.find(key_a).isNull());
+        CHECK(cache.find(key_b).isNull());
+        CHECK(cache.hits() == 0);
+        // the broken pack is replaced by the masks rendered since
+        cache.insert(key_a, mask_a);
+        CHECK(cache.save());
+        cache.close();
+        CHECK(cache.open(directory, "source-a", 5));
+        CHECK(SamePixels(cache.find(key_a), mask_a));
+        cache.close();
+        CHECK(Rewrite(pack, restore));
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <QGuiApplication>
+#include <QTemporaryDir>
+#include <QtIconFont>
+#include <QtIconFontSearch>
+#include "testfont.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static QStringList ClassesOf(const QVector<QtIconFontSearch::Match_t> &matches) {
+    QStringList classes;
+    for (auto const &match : matches) classes.append(match.info->font_class);
+    return classes;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication a(argc, argv);
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    CHECK(WriteTestFont(dir.filePath("search"), "Search Test", "search_test",
+                        {{"1", "Trolley", "c-a-r-t", 0xE001}, {"2", "Scar", "scar", 0xE002},
+                         {"3", "Card", "card", 0xE003}, {"4", "Car", "car", 0xE004},
+                         {"5", "House", "home", 0xE005}}));
+    QtIconFont font(dir.filePath("search.ttf"), dir.filePath("search.json"));
+    CHECK(font.isValid());
+
+    // ------ ranking: exact > prefix > substring > fuzzy subsequence
+    QtIconFontSearch fuzzy(&font);
+    CHECK(fuzzy.matchMode() == QtIconFontSearch::FuzzyMatch);
+    auto matches = fuzzy.search("car");
+    CHECK(ClassesOf(matches) == QStringList({"car", "card", "scar", "c-a-r-t"}));
+    for (int i = 1; i < matches.size(); ++i) CHECK(matches[i - 1].score > matches[i].score);
+    CHECK(matches.first().info->unicode_decimal == 0xE004);
+    // case insensitive, names are searched too
+    CHECK(ClassesOf(fuzzy.search("TROLL")) == QStringList({"c-a-r-t"}));
+    CHECK(ClassesOf(fuzzy.search("car", 2)) == QStringList({"car", "card"}));
+    CHECK(fuzzy.search("").isEmpty());
+    CHECK(fuzzy.search("zzz").isEmpty());
+
+    // ------ incremental updates give the same results as a search from scratch
+    QtIconFontSearch incremental(&font);
+    QStringList typed;
+    for (auto query : {"c", "ca", "car", "card"}) typed = ClassesOf(incremental.search(query));
+    CHECK(typed == QStringList({"card"}));
+    fuzzy.reset();
+    CHECK(ClassesOf(fuzzy.search("card")) == typed);
+    // a query which does not extend the previous one searches all glyphs again
+    CHECK(ClassesOf(incremental.search("ho")) == QStringList({"home"}));
+    CHECK(ClassesOf(incremental.search("c")).size() == 4);
+    // an empty query forgets the previous one
+    CHECK(incremental.search("").isEmpty());
+    CHECK(ClassesOf(incremental.search("scar")) == QStringList({"scar"}));
+
+    // ------ prefix mode matches starts of class names and names only
+    QtIconFontSearch prefix(font.handle(), QtIconFontSearch::PrefixMatch);
+    CHECK(ClassesOf(prefix.search("car")) == QStringList({"car", "card"}));
+    CHECK(ClassesOf(prefix.search("card")) == QStringList({"card"}));
+    CHECK(ClassesOf(prefix.search("hou")) == QStringList({"home"}));
+    CHECK(prefix.search("ar").isEmpty());
+
+    // ------ async search gives the same results
+    auto future = fuzzy.searchAsync("car");
+    future.waitForFinished();
+    CHECK(ClassesOf(future.result()) == QStringList({"car", "card", "scar", "c-a-r-t"}));
+
+    // ------ a search without a font finds nothing
+    QtIconFontSearch empty(static_cast<const QtIconFont *>(nullptr));
+    CHECK(empty.search("car").isEmpty());
+
+    return 0;
+}
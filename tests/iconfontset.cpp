@@ -0,0 +1,94 @@
+#include <QGuiApplication>
+#include <QTemporaryDir>
+#include <QtIconFont>
+#include <QtIconFontSet>
+#include "testfont.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static uint32_t CodeOf(const QtIconFontSet::Glyph_t &glyph) {
+    return glyph ? glyph.info->unicode_decimal : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication a(argc, argv);
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    CHECK(WriteTestFont(dir.filePath("a"), "Set Test A", "set_a",
+                        {{"1", "home", "home", 0xE001}, {"2", "search", "search", 0xE002},
+                         {"3", "a", "only_a", 0xE003}}));
+    CHECK(WriteTestFont(dir.filePath("b"), "Set Test B", "set_b",
+                        {{"1", "home", "home", 0xE101}, {"4", "b", "only_b", 0xE102}}));
+    CHECK(WriteTestFont(dir.filePath("c"), "Set Test C", "set_c", {{"1", "home", "home", 0xE201}}));
+    QtIconFont font_a(dir.filePath("a.ttf"), dir.filePath("a.json"));
+    QtIconFont font_b(dir.filePath("b.ttf"), dir.filePath("b.json"));
+    QtIconFont font_c(dir.filePath("c.ttf"), dir.filePath("c.json"));
+    CHECK(font_a.isValid() && font_b.isValid() && font_c.isValid());
+
+    QtIconFontSet set;
+    CHECK(!set.addFont(QStringLiteral("missing")));
+    CHECK(set.addFont(&font_a));
+    CHECK(set.addFont(&font_b));
+    CHECK(!set.addFont(&font_a));
+    CHECK(set.contains("set_a"));
+
+    // ------ equal priority, the member added first wins
+    CHECK(CodeOf(set.glyphByClass("home")) == 0xE001);
+    CHECK(set.glyphByClass("home").font.fontName() == "set_a");
+    CHECK(CodeOf(set.glyphById(QLatin1String("1"))) == 0xE001);
+    CHECK(CodeOf(set.glyphByClass(QLatin1String("only_b"))) == 0xE102);
+    CHECK(CodeOf(set.glyphById(QStringView(u"4"))) == 0xE102);
+    CHECK(!set.glyphByClass("missing"));
+
+    // ------ higher priority wins regardless of order
+    CHECK(set.addFont(&font_c, 1));
+    CHECK(CodeOf(set.glyphByClass("home")) == 0xE201);
+    CHECK(set.fonts() == QStringList({"set_c", "set_a", "set_b"}));
+
+    // ------ removal falls back to the next best member
+    CHECK(set.removeFont("set_c"));
+    CHECK(!set.removeFont("set_c"));
+    CHECK(CodeOf(set.glyphByClass("home")) == 0xE001);
+    auto held = set.glyphByClass("only_a");
+    CHECK(set.removeFont("set_a"));
+    CHECK(!set.contains("set_a"));
+    CHECK(CodeOf(set.glyphByClass("home")) == 0xE101);
+    CHECK(!set.glyphByClass("only_a"));
+    CHECK(!set.glyphByClass("search"));
+    CHECK(CodeOf(set.glyphByClass("only_b")) == 0xE102);
+    // glyphs looked up before keep their font alive
+    CHECK(CodeOf(held) == 0xE003);
+    CHECK(held.font.fontName() == "set_a");
+
+    // ------ a member added again comes after the members already in the set
+    CHECK(set.addFont(&font_a));
+    CHECK(CodeOf(set.glyphByClass("home")) == 0xE101);
+    CHECK(CodeOf(set.glyphByClass("only_a")) == 0xE003);
+    CHECK(set.fonts() == QStringList({"set_b", "set_a"}));
+
+    // ------ ids of removed members are reused, the set does not grow with churn
+    for (int i = 0; i < 100; ++i) {
+        CHECK(set.addFont(&font_c, i % 2 == 0 ? 1 : -1));
+        CHECK(CodeOf(set.glyphByClass("home")) == (i % 2 == 0 ? 0xE201 : 0xE101));
+        CHECK(set.removeFont("set_c"));
+        CHECK(CodeOf(set.glyphByClass("home")) == 0xE101);
+    }
+    CHECK(set.fonts() == QStringList({"set_b", "set_a"}));
+
+    // ------ reloading keeps priority and order
+    CHECK(set.reloadFont("set_b"));
+    CHECK(CodeOf(set.glyphByClass("home")) == 0xE101);
+    CHECK(set.fonts() == QStringList({"set_b", "set_a"}));
+    CHECK(!set.reloadFont("set_c"));
+
+    return 0;
+}
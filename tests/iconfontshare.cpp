@@ -0,0 +1,76 @@
+#include <QFile>
+#include <QFontDatabase>
+#include <QGuiApplication>
+#include <QTemporaryDir>
+#include <QtIconFont>
+#include "testfont.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static bool Registered(const QString &family) {
+    return QFontDatabase().families().contains(family);
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication a(argc, argv);
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    const QVector<TestGlyph_t> glyphs = {{"1", "home", "home", 0xE001}, {"2", "search", "search", 0xE002}};
+    CHECK(WriteTestFont(dir.filePath("share"), "Share Test", "share_test", glyphs));
+    // the same bytes under other names
+    CHECK(QFile::copy(dir.filePath("share.ttf"), dir.filePath("copy.ttf")));
+    CHECK(QFile::copy(dir.filePath("share.json"), dir.filePath("copy.json")));
+    // other glyphs, so the json differs while the font is the same
+    CHECK(WriteTestFile(dir.filePath("other.json"), TestJsonData("share_other", {glyphs.first()})));
+    CHECK(!Registered("Share Test"));
+
+    // ------ the same content is registered once and shared
+    auto *font = new QtIconFont(dir.filePath("share.ttf"), dir.filePath("share.json"));
+    auto *copy = new QtIconFont(dir.filePath("copy.ttf"), dir.filePath("copy.json"));
+    CHECK(font->isValid() && copy->isValid());
+    CHECK(Registered("Share Test"));
+    CHECK(copy->fontFamily() == font->fontFamily());
+    // glyph infos live in the shared data
+    CHECK(copy->fontInfoByClass("home").data() == font->fontInfoByClass("home").data());
+
+    // ------ a different manifest is different content
+    auto *other = new QtIconFont(dir.filePath("share.ttf"), dir.filePath("other.json"));
+    CHECK(other->isValid());
+    CHECK(other->fontInfoByClass("home").data() != font->fontInfoByClass("home").data());
+    CHECK(other->fontInfoByClass("search").isNull());
+    delete other;
+
+    // ------ the font stays registered while any object or handle uses it
+    auto handle = font->handle();
+    auto info = copy->fontInfoById(QLatin1String("2"));
+    delete font;
+    CHECK(Registered("Share Test"));
+    delete copy;
+    CHECK(Registered("Share Test"));
+    CHECK(handle.isValid());
+    CHECK(handle.iconByClass(QLatin1String("home")) == QChar(0xE001));
+    handle = {};
+    CHECK(Registered("Share Test"));
+    // infos keep the data too
+    CHECK(info->font_class == "search");
+    info.reset();
+
+    // ------ the last release removes it from the font database, loading it again registers it again
+    CHECK(!Registered("Share Test"));
+    CHECK(!QtIconFont::AcquireIconFont("share_test").isValid());
+    QtIconFont again(dir.filePath("share.ttf"), dir.filePath("share.json"));
+    CHECK(again.isValid());
+    CHECK(Registered("Share Test"));
+    CHECK(QtIconFont::AcquireIconFont("share_test").isValid());
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <QApplication>
+#include <QtIconFont>
+#include <QtIconLabel>
+#include <QGridLayout>
+#include <QTimer>
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+int main(int argc, char *argv[]) {
+    QApplication a(argc, argv);
+
+    static auto constexpr kColumns = 50;
+    static auto constexpr kRows = 40;
+
+    QtIconFont icon_font("iconfont.ttf", "iconfont.json");
+
+    auto *p = new QWidget;
+    auto *l = new QGridLayout(p);
+    l->setSpacing(4);
+
+    // a dashboard of status icons, each one is a single pixmap blit
+    QVector<QtIconLabel *> labels;
+    for (int row = 0; row < kRows; ++row) {
+        for (int column = 0; column < kColumns; ++column) {
+            auto *i = new QtIconLabel(&icon_font, "churujingjiekoufuwu", p);
+            i->setIconSize(16);
+            i->setIconColor(Qt::darkGreen);
+            l->addWidget(i, row, column);
+            labels.append(i);
+        }
+    }
+
+    // flip some of them to an error state every second
+    auto *timer = new QTimer(p);
+    QObject::connect(timer, &QTimer::timeout, [&labels] {
+        static int tick = 0;
+        for (int i = tick % 7; i < labels.size(); i += 7) {
+            labels[i]->setIconColor(labels[i]->iconColor() == Qt::red ? Qt::darkGreen : Qt::red);
+        }
+        ++tick;
+    });
+    timer->start(1000);
+
+    p->show();
+
+    return QApplication::exec();
+}
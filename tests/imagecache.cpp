@@ -0,0 +1,156 @@
+#include <QGuiApplication>
+#include <QTimer>
+#include <QtConcurrent>
+#include "../src/qtimagecache_p.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static QPixmap Scaled(int size) {
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::gray);
+    return QPixmap::fromImage(image);
+}
+
+static QtScaledImageKey_t Key(qint64 source, int size = 64) {
+    return {source, QSize(size, size), Qt::KeepAspectRatio, 1.0};
+}
+
+static qint64 BytesOf(const QPixmap &pixmap) {
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication a(argc, argv);
+
+    // ------ pyramid level selection: the smallest level which is not smaller than the target
+    {
+        QImage source(1024, 768, QImage::Format_ARGB32_Premultiplied);
+        source.fill(Qt::white);
+        QtImagePyramid pyramid(source, kDefaultPyramidLimit);
+        CHECK(pyramid.levelFor({2000, 2000}).size() == QSize(1024, 768));
+        CHECK(pyramid.levelFor({1024, 768}).size() == QSize(1024, 768));
+        CHECK(pyramid.usedBytes() == 0);
+        CHECK(pyramid.levelFor({600, 300}).size() == QSize(1024, 768));
+        CHECK(pyramid.levelFor({300, 300}).size() == QSize(512, 384));
+        CHECK(pyramid.levelFor({256, 192}).size() == QSize(256, 192));
+        CHECK(pyramid.levelFor({255, 10}).size() == QSize(256, 192));
+        // the last level is the one whose half would be empty
+        CHECK(pyramid.levelFor({1, 1}).size() == QSize(2, 1));
+        // every level is kept once
+        auto kept = pyramid.usedBytes();
+        CHECK(kept > 0 && kept < source.sizeInBytes() / 2);
+        CHECK(pyramid.levelFor({100, 90}).size() == QSize(128, 96));
+        CHECK(pyramid.usedBytes() == kept);
+    }
+    {
+        // a thin image stops when one side would become empty
+        QImage source(1000, 10, QImage::Format_ARGB32_Premultiplied);
+        source.fill(Qt::white);
+        QtImagePyramid pyramid(source, kDefaultPyramidLimit);
+        CHECK(pyramid.levelFor({1, 1}).size() == QSize(125, 1));
+        CHECK(pyramid.levelFor({200, 1}).size() == QSize(250, 2));
+    }
+    {
+        // levels over the limit are built but not kept
+        QImage source(1024, 1024, QImage::Format_ARGB32_Premultiplied);
+        source.fill(Qt::white);
+        QtImagePyramid pyramid(source, 512 * 512 * 4);
+        CHECK(pyramid.levelFor({256, 256}).size() == QSize(256, 256));
+        CHECK(pyramid.usedBytes() == 512 * 512 * 4);
+        QtImagePyramid unkept(source, 0);
+        CHECK(unkept.levelFor({256, 256}).size() == QSize(256, 256));
+        CHECK(unkept.usedBytes() == 0);
+    }
+    {
+        // concurrent jobs get the same levels and keep each level once
+        QImage source(2048, 2048, QImage::Format_ARGB32_Premultiplied);
+        source.fill(Qt::white);
+        QtImagePyramid pyramid(source, kDefaultPyramidLimit);
+        QVector<int> sizes;
+        for (int i = 0; i < 64; ++i) sizes.append(2048 >> (1 + i % 8));
+        auto levels = QtConcurrent::blockingMapped<QVector<int>>(sizes, [&pyramid](int size) {
+            return pyramid.levelFor({size, size}).width();
+        });
+        for (int i = 0; i < sizes.size(); ++i) CHECK(levels[i] == sizes[i]);
+        qint64 expected = 0;
+        for (int size = 1024; size >= 8; size /= 2) expected += qint64(size) * size * 4;
+        CHECK(pyramid.usedBytes() == expected);
+    }
+
+    // ------ shared cache byte accounting
+    auto &cache = QtScaledImageCache::Instance();
+    auto const bytes = BytesOf(Scaled(64));
+    cache.setLimit(2 * bytes);
+    {
+        // held entries count once, however many widgets hold them
+        cache.acquire(Key(1));
+        cache.acquire(Key(1));
+        CHECK(cache.usedBytes() == 0);
+        cache.store(Key(1), Scaled(64));
+        CHECK(cache.usedBytes() == bytes);
+        // a second store keeps the first scaled image, the one holders already share
+        auto first = cache.find(Key(1));
+        CHECK(cache.store(Key(1), Scaled(64)).cacheKey() == first.cacheKey());
+        CHECK(cache.usedBytes() == bytes);
+        cache.release(Key(1));
+        cache.release(Key(1));
+        // unheld entries are kept within the limit
+        CHECK(!cache.find(Key(1)).isNull());
+        CHECK(cache.usedBytes() == bytes);
+
+        cache.acquire(Key(2));
+        cache.store(Key(2), Scaled(64));
+        cache.acquire(Key(3));
+        cache.store(Key(3), Scaled(64));
+        // the least recently used unheld entry is dropped
+        CHECK(cache.find(Key(1)).isNull());
+        CHECK(cache.usedBytes() == 2 * bytes);
+
+        // held entries stay beyond the limit
+        cache.setLimit(0);
+        CHECK(cache.usedBytes() == 2 * bytes);
+        cache.release(Key(2));
+        CHECK(cache.find(Key(2)).isNull());
+        CHECK(cache.usedBytes() == bytes);
+
+        // an entry released before it is scaled is dropped, a late store is not counted
+        cache.acquire(Key(4));
+        cache.release(Key(4));
+        CHECK(!cache.store(Key(4), Scaled(64)).isNull());
+        CHECK(cache.find(Key(4)).isNull());
+        CHECK(cache.usedBytes() == bytes);
+
+        cache.release(Key(3));
+        CHECK(cache.usedBytes() == 0);
+    }
+
+    // ------ once the application quits, unheld entries are dropped whatever the limit
+    cache.setLimit(kDefaultSharedCacheLimit);
+    cache.acquire(Key(5));
+    cache.store(Key(5), Scaled(64));
+    cache.release(Key(5));
+    cache.acquire(Key(6));
+    cache.store(Key(6), Scaled(64));
+    CHECK(cache.usedBytes() == 2 * bytes);
+    QTimer::singleShot(0, &a, &QCoreApplication::quit);
+    QGuiApplication::exec();
+    CHECK(cache.find(Key(5)).isNull());
+    CHECK(cache.usedBytes() == bytes);
+    cache.release(Key(6));
+    CHECK(cache.usedBytes() == 0);
+    cache.acquire(Key(7));
+    cache.store(Key(7), Scaled(64));
+    cache.release(Key(7));
+    CHECK(cache.usedBytes() == 0);
+
+    return 0;
+}
@@ -1,35 +1,125 @@
 #include <QApplication>
+#include <QCheckBox>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLinearGradient>
+#include <QMouseEvent>
+#include <QPainter>
 #include <QtImageWidget>
 #include <QVBoxLayout>
+#include <QWheelEvent>
 
 FNRICE_QT_WIDGETS_USE_NAMESPACE
 
+/**
+ * @brief wheel zooms and dragging pans a tiled image widget
+ */
+class TiledNavigator : public QObject {
+ public:
+    explicit TiledNavigator(QtImageWidget *parent) : QObject(parent), widget(parent) {}
+
+ protected:
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        switch (event->type()) {
+            case QEvent::Wheel: {
+                auto *wheel = static_cast<QWheelEvent *>(event);
+                this->widget->setImageZoom(this->widget->imageZoom() * (wheel->angleDelta().y() > 0 ? 1.25 : 0.8));
+                return true;
+            }
+            case QEvent::MouseButtonPress:
+                this->last_pos = static_cast<QMouseEvent *>(event)->pos();
+                return true;
+            case QEvent::MouseMove: {
+                auto pos = static_cast<QMouseEvent *>(event)->pos();
+                // the pan is in image pixels, dragging right moves the image right
+                auto delta = QPointF(pos - this->last_pos) / this->widget->imageZoom();
+                this->widget->setImagePan(this->widget->imagePan() - delta);
+                this->last_pos = pos;
+                return true;
+            }
+            default:
+                return QObject::eventFilter(watched, event);
+        }
+    }
+
+ private:
+    QtImageWidget *widget;
+    QPoint last_pos;
+};
+
+static QImage LargeImage() {
+    // large enough to be scaled asynchronously and through the pyramid
+    QImage image(4096, 3072, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    QLinearGradient gradient(0, 0, image.width(), image.height());
+    gradient.setColorAt(0, Qt::darkBlue);
+    gradient.setColorAt(1, Qt::darkYellow);
+    painter.fillRect(image.rect(), gradient);
+    painter.setPen(QPen(Qt::white, 8));
+    for (int x = 0; x < image.width(); x += 256) painter.drawLine(x, 0, x, image.height());
+    for (int y = 0; y < image.height(); y += 256) painter.drawLine(0, y, image.width(), y);
+    return image;
+}
+
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
 
     static auto constexpr kSpacing = 10;
-    static auto constexpr kBlockSize = 120;
+    static auto constexpr kBlockSize = 240;
 
-    auto *p = new QWidget;
-    p->setMinimumSize(kBlockSize * 2 + kSpacing * 3, kBlockSize + kSpacing * 2);
-    p->resize(kBlockSize * 2 + kSpacing * 3, kBlockSize + kSpacing * 2);
+    // a large image file, decoded at the displayed size or shown tiled, e.g. a photo of some thousands of pixels
+    auto const file_name = argc > 1 ? QString::fromLocal8Bit(argv[1]) : QString();
+    auto const image = LargeImage();
 
+    auto *p = new QWidget;
     auto *l = new QVBoxLayout(p);
+    auto *options = new QHBoxLayout;
+    auto *pyramid = new QCheckBox("pyramid", p);
+    auto *decode = new QCheckBox("decode at displayed size", p);
+    auto *shared = new QCheckBox("shared cache", p);
+    auto *tiled = new QCheckBox("tiled", p);
+    pyramid->setChecked(true);
+    shared->setChecked(true);
+    decode->setEnabled(!file_name.isEmpty());
+    tiled->setEnabled(!file_name.isEmpty());
+    for (auto *option : {pyramid, decode, shared, tiled}) options->addWidget(option);
+    l->addLayout(options);
 
-    auto *i = new QtImageWidget(p);
-    i->move(kSpacing, kSpacing);
-    i->resize(kBlockSize, kBlockSize);
-    i->setPixmap(QPixmap("E:/temp/1.png"));
-    i->setBorderWidth(1);
-    i->setBorderStyle(Qt::SolidLine);
-    i->setBorderColor(Qt::red);
-    i->setBorderRadius(10);
-    i->setStyleSheet(R"(background: blue;)");
+    auto *blocks = new QWidget(p);
+    auto *g = new QGridLayout(blocks);
+    g->setSpacing(kSpacing);
+    l->addWidget(blocks, 1);
 
-    i->setImageMaximumPixelSize({240, 240});
-    i->setImageMaximumPercent(80);
+    // the same pixmap everywhere is scaled once and kept once, copies are scaled and kept per widget
+    auto const pixmap = QPixmap::fromImage(image);
+    auto rebuild = [=] {
+        qDeleteAll(blocks->findChildren<QtImageWidget *>(QString(), Qt::FindDirectChildrenOnly));
+        auto const count = tiled->isChecked() ? 1 : 4;
+        for (int index = 0; index < count; ++index) {
+            auto *i = new QtImageWidget(blocks);
+            i->setMinimumSize(kBlockSize, kBlockSize);
+            i->setBorderWidth(1);
+            i->setBorderStyle(Qt::SolidLine);
+            i->setBorderColor(Qt::red);
+            i->setBorderRadius(10);
+            i->setStyleSheet(R"(background: blue;)");
+            i->setImagePyramidLimit(pyramid->isChecked() ? 64 * 1024 * 1024 : 0);
+            if (tiled->isChecked()) {
+                i->setTiledImageSource(file_name);
+                i->installEventFilter(new TiledNavigator(i));
+            } else if (decode->isChecked()) {
+                i->setImageSource(file_name);
+            } else {
+                i->setPixmap(shared->isChecked() ? pixmap : QPixmap::fromImage(image));
+            }
+            g->addWidget(i, index / 2, index % 2);
+        }
+    };
+    for (auto *option : {pyramid, decode, shared, tiled}) QObject::connect(option, &QCheckBox::toggled, rebuild);
+    rebuild();
 
-    l->addWidget(i);
+    // resizing the window rescales all images
+    p->resize(kBlockSize * 2 + kSpacing * 3, kBlockSize * 2 + kSpacing * 4 + options->sizeHint().height());
     p->show();
 
     return QApplication::exec();
@@ -0,0 +1,129 @@
+#include <QCoreApplication>
+#include <QtIconFont>
+#include "../src/qtglyphjsonreader_p.h"
+#include "../src/qtglyphtable_p.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static const char kJson[] = R"({
+    "name": "test",
+    "description": "reader test",
+    "glyphs": [
+        {"icon_id": "101", "name": "home", "font_class": "home", "unicode": "e601", "unicode_decimal": 58881},
+        {"icon_id": "102", "name": "search", "font_class": "search", "unicode": "e602", "unicode_decimal": 58882}
+    ]
+})";
+
+static bool Read(const QByteArray &json, QtGlyphTable *table) {
+    QtGlyphJsonReader reader(json.constData(), json.size(), table);
+    return reader.read();
+}
+
+static QByteArray Glyph(const QByteArray &font_class, const QByteArray &unicode_decimal) {
+    return R"({"icon_id": "1", "name": "n", "font_class": ")" + font_class + R"(", "unicode": "u", "unicode_decimal": )"
+        + unicode_decimal + "}";
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+
+    // ------ plain document
+    {
+        QtGlyphTable table;
+        CHECK(Read(kJson, &table));
+        CHECK(table.size() == 2);
+        CHECK(table.fontName() == "test");
+        CHECK(table.description() == "reader test");
+        auto i = table.find(QtGlyphTable::FontClassIndex, QLatin1String("search"));
+        CHECK(i >= 0);
+        CHECK(table.record(i).unicode_decimal == 58882);
+    }
+
+    // ------ escapes
+    {
+        QtGlyphTable table;
+        CHECK(Read(R"({"name": "a\"b\\c\/d\b\f\n\r\té中", "glyphs": []})", &table));
+        CHECK(table.fontName() == QString::fromUtf8("a\"b\\c/d\b\f\n\r\t\xC3\xA9\xE4\xB8\xAD"));
+        CHECK(!Read(R"({"name": "\x"})", &table));
+        CHECK(!Read(R"({"name": "\u12G4"})", &table));
+        CHECK(!Read("{\"name\": \"a\tb\"}", &table));
+    }
+
+    // ------ surrogate pairs, escaped and as utf-8
+    {
+        QtGlyphTable escaped, raw;
+        CHECK(Read(R"({"name": "\ud83d\ude00"})", &escaped));
+        CHECK(Read("{\"name\": \"\xF0\x9F\x98\x80\"}", &raw));
+        auto expected = QString::fromUcs4(U"\U0001F600", 1);
+        CHECK(escaped.fontName() == expected);
+        CHECK(raw.fontName() == expected);
+        // encoded surrogates and overlong sequences are not valid utf-8
+        CHECK(!Read("{\"name\": \"\xED\xA0\xBD\"}", &raw));
+        CHECK(!Read("{\"name\": \"\xC0\xAF\"}", &raw));
+    }
+
+    // ------ nesting, unknown values of any shape are skipped
+    {
+        QtGlyphTable table;
+        CHECK(Read(R"({"extra": {"a": [1, -2.5e3, true, false, null, {"b": [[], {}]}]},
+                       "glyphs": [[1, 2], "x", {"font_class": "a", "more": {"c": [null]}},)"
+                       + Glyph("b", "1") + "]}",
+                   &table));
+        CHECK(table.size() == 1);
+        CHECK(table.find(QtGlyphTable::FontClassIndex, QLatin1String("b")) == 0);
+        // bounded depth, so hostile documents cannot overflow the stack
+        CHECK(!Read("{\"extra\": " + QByteArray(1000, '[') + QByteArray(1000, ']') + "}", &table));
+    }
+
+    // ------ truncated input, every prefix is rejected
+    {
+        QByteArray json(kJson);
+        for (int size = 0; size < json.size(); ++size) {
+            QtGlyphTable table;
+            QtGlyphJsonReader reader(json.constData(), size, &table);
+            CHECK(!reader.read());
+            CHECK(reader.errorOffset() >= 0 && reader.errorOffset() <= size);
+        }
+        QtGlyphTable table;
+        CHECK(!Read(QByteArray(kJson) + "}", &table));
+    }
+
+    // ------ duplicate keys, the last one wins
+    {
+        QtGlyphTable table;
+        CHECK(Read(R"({"name": "first", "glyphs": [)" + Glyph("a", "1") + "," + Glyph("b", "2")
+                       + R"(], "name": "second", "glyphs": [)" + Glyph("c", "3") + "]}",
+                   &table));
+        CHECK(table.fontName() == "second");
+        CHECK(table.size() == 1);
+        CHECK(table.find(QtGlyphTable::FontClassIndex, QLatin1String("a")) == -1);
+        CHECK(table.find(QtGlyphTable::FontClassIndex, QLatin1String("c")) == 0);
+        QtGlyphTable cleared;
+        CHECK(Read(R"({"glyphs": [)" + Glyph("a", "1") + R"(], "glyphs": null})", &cleared));
+        CHECK(cleared.size() == 0);
+    }
+
+    // ------ unicode_decimal which is not a code point becomes 0
+    {
+        const char *invalid[] = {"-1", "1.5", "1114112", "1e300", "-1e300", "123456789012345678901234567890"};
+        for (auto value : invalid) {
+            QtGlyphTable table;
+            CHECK(Read(R"({"glyphs": [)" + Glyph("a", value) + "]}", &table));
+            CHECK(table.size() == 1);
+            CHECK(table.record(0).unicode_decimal == 0);
+        }
+        QtGlyphTable table;
+        CHECK(Read(R"({"glyphs": [)" + Glyph("a", "1114111.0") + "]}", &table));
+        CHECK(table.record(0).unicode_decimal == 0x10FFFF);
+    }
+
+    return 0;
+}
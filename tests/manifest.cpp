@@ -0,0 +1,92 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtIconFont>
+#include <cstring>
+#include "../src/qtglyphtable_p.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            qCritical("%s:%d: check failed: %s", __FILE__, __LINE__, #condition); \
+            return 1;                                                           \
+        }                                                                       \
+    } while (false)
+
+static const char kJson[] = R"({
+    "id": "1",
+    "name": "test",
+    "font_family": "iconfont",
+    "css_prefix_text": "icon-",
+    "description": "manifest test",
+    "glyphs": [
+        {"icon_id": "101", "name": "home", "font_class": "home", "unicode": "e601", "unicode_decimal": 58881},
+        {"icon_id": "102", "name": "search", "font_class": "search", "unicode": "e602", "unicode_decimal": 58882},
+        {"icon_id": "103", "name": "setting", "font_class": "setting", "unicode": "e603", "unicode_decimal": 58883}
+    ]
+})";
+
+static bool WriteFile(const QString &path, const QByteArray &data) {
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+    QTemporaryDir dir;
+    CHECK(dir.isValid());
+    auto json = dir.filePath("iconfont.json");
+    auto manifest = dir.filePath("iconfont.qifm");
+    CHECK(WriteFile(json, kJson));
+
+    // ------ round trip: json -> manifest -> mapped table
+    CHECK(QtIconFont::CompileManifest(json, manifest));
+    QString error;
+    QtGlyphTable table;
+    CHECK(table.map(manifest, &error));
+    CHECK(table.size() == 3);
+    CHECK(table.fontName() == "test");
+    CHECK(table.description() == "manifest test");
+    auto i = table.find(QtGlyphTable::FontClassIndex, QLatin1String("search"));
+    CHECK(i >= 0);
+    CHECK(table.record(i).unicode_decimal == 58882);
+    CHECK(table.string(table.record(i).icon_id) == QLatin1String("102"));
+    CHECK(table.find(QtGlyphTable::IconIdIndex, QStringView(u"103")) >= 0);
+    CHECK(table.find(QtGlyphTable::NameIndex, QLatin1String("home")) >= 0);
+    CHECK(table.find(QtGlyphTable::FontClassIndex, QLatin1String("missing")) == -1);
+
+    QFile file(manifest);
+    CHECK(file.open(QIODevice::ReadOnly));
+    auto bytes = file.readAll();
+    file.close();
+
+    // ------ truncated file
+    auto truncated = dir.filePath("truncated.qifm");
+    CHECK(WriteFile(truncated, bytes.left(bytes.size() / 2)));
+    QtGlyphTable truncated_table;
+    CHECK(!truncated_table.map(truncated, &error));
+    CHECK(!truncated_table.load(bytes.left(int(sizeof(QtGlyphTable::Header_t)) - 1), &error));
+
+    // ------ bad magic
+    auto bad_magic = bytes;
+    bad_magic[0] = 'X';
+    QtGlyphTable bad_magic_table;
+    CHECK(!bad_magic_table.load(bad_magic, &error));
+
+    // ------ every slot of an index taken, lookups of missing keys must still end
+    QtGlyphTable::Header_t header{};
+    std::memcpy(&header, bytes.constData(), sizeof(header));
+    auto full = bytes;
+    auto *index = reinterpret_cast<quint32 *>(full.data() + header.indexes_offset)
+        + header.index_capacity * QtGlyphTable::FontClassIndex;
+    for (quint32 slot = 0; slot < header.index_capacity; ++slot) index[slot] = 1;
+    QtGlyphTable full_table;
+    CHECK(full_table.load(full, &error));
+    CHECK(full_table.find(QtGlyphTable::FontClassIndex, QLatin1String("missing")) == -1);
+    auto first = full_table.string(full_table.record(0).font_class);
+    CHECK(full_table.find(QtGlyphTable::FontClassIndex, first) == 0);
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+#ifndef QTWIDGETS_TESTS_TESTFONT_H_
+#define QTWIDGETS_TESTS_TESTFONT_H_
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+/**
+ * @brief glyph of a generated test font, its outline is a rectangle whose height depends on the code point
+ */
+struct TestGlyph_t {
+    QString icon_id;
+    QString name;
+    QString font_class;
+    uint32_t codepoint;
+};
+
+static QByteArray TestSfntTable(const std::function<void(QDataStream &)> &write) {
+    QByteArray table;
+    QDataStream out(&table, QIODevice::WriteOnly); // big-endian, same as sfnt
+    write(out);
+    return table;
+}
+
+static int TestLog2(int value) {
+    int log = 0;
+    while ((2 << log) <= value) ++log;
+    return log;
+}
+
+/**
+ * @brief build a minimal truetype font: one rectangle per glyph, glyph i + 1 is mapped from glyphs[i].codepoint
+ */
+static QByteArray TestFontData(const QString &family, const QVector<TestGlyph_t> &glyphs) {
+    auto glyph_count = quint16(glyphs.size() + 1); // .notdef first
+    QMap<QByteArray, QByteArray> tables; // sorted by tag, as the table directory must be
+
+    tables["head"] = TestSfntTable([](QDataStream &out) {
+        out << quint32(0x00010000) << quint32(0x00010000) << quint32(0) << quint32(0x5F0F3CF5)
+            << quint16(0x000B) << quint16(1000) << quint64(0) << quint64(0)
+            << qint16(0) << qint16(0) << qint16(1000) << qint16(800)
+            << quint16(0) << quint16(8) << qint16(2) << qint16(1) << qint16(0);
+    });
+    tables["hhea"] = TestSfntTable([glyph_count](QDataStream &out) {
+        out << quint32(0x00010000) << qint16(800) << qint16(-200) << qint16(0) << quint16(1000)
+            << qint16(0) << qint16(0) << qint16(1000) << qint16(1) << qint16(0) << qint16(0)
+            << qint16(0) << qint16(0) << qint16(0) << qint16(0) << qint16(0) << glyph_count;
+    });
+    tables["maxp"] = TestSfntTable([glyph_count](QDataStream &out) {
+        out << quint32(0x00010000) << glyph_count << quint16(4) << quint16(1);
+        for (auto value : {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0}) out << quint16(value);
+    });
+    auto first = glyphs.isEmpty() ? 0u : 0xFFFFu, last = 0u;
+    for (auto const &glyph : glyphs) {
+        first = std::min(first, std::min(glyph.codepoint, 0xFFFFu));
+        last = std::max(last, std::min(glyph.codepoint, 0xFFFFu));
+    }
+    tables["OS/2"] = TestSfntTable([first, last](QDataStream &out) {
+        out << quint16(1) << qint16(1000) << quint16(400) << quint16(5) << quint16(0);
+        for (int i = 0; i < 11; ++i) out << qint16(0); // sub/superscript, strikeout, family class
+        for (int i = 0; i < 10; ++i) out << quint8(0); // panose
+        out << quint32(0) << quint32(1u << 28) << quint32(0) << quint32(0); // private use area
+        out.writeRawData("NONE", 4);
+        out << quint16(0x0040) << quint16(first) << quint16(last) << qint16(800) << qint16(-200) << qint16(0)
+            << quint16(800) << quint16(200) << quint32(1) << quint32(0);
+    });
+
+    QByteArray glyf, loca, hmtx;
+    QDataStream loca_out(&loca, QIODevice::WriteOnly), hmtx_out(&hmtx, QIODevice::WriteOnly);
+    loca_out << quint32(0);
+    hmtx_out << quint16(1000) << qint16(0);
+    for (int i = 0; i < glyphs.size(); ++i) {
+        qint16 x_min = 100, y_min = 0, x_max = 900, y_max = qint16(100 + glyphs[i].codepoint % 700);
+        glyf += TestSfntTable([=](QDataStream &out) {
+            out << qint16(1) << x_min << y_min << x_max << y_max << quint16(3) << quint16(0);
+            for (int point = 0; point < 4; ++point) out << quint8(0x01); // on curve, 16-bit deltas
+            out << x_min << qint16(0) << qint16(x_max - x_min) << qint16(0);
+            out << y_min << qint16(y_max - y_min) << qint16(0) << qint16(y_min - y_max);
+            out << quint16(0); // pad to 4 bytes
+        });
+        loca_out << quint32(glyf.size());
+        hmtx_out << quint16(1000) << x_min;
+    }
+    tables["glyf"] = glyf;
+    tables["loca"] = loca;
+    tables["hmtx"] = hmtx;
+
+    // format 4 for the bmp and format 12 for everything, one segment per glyph
+    QVector<QPair<uint32_t, quint16>> mapping;
+    for (int i = 0; i < glyphs.size(); ++i) mapping.append({glyphs[i].codepoint, quint16(i + 1)});
+    std::sort(mapping.begin(), mapping.end());
+    QVector<QPair<uint32_t, quint16>> bmp;
+    for (auto const &pair : mapping) {
+        if (pair.first < 0xFFFF) bmp.append(pair);
+    }
+    auto format4 = TestSfntTable([&bmp](QDataStream &out) {
+        auto seg_count = bmp.size() + 1;
+        auto search_range = 2 << TestLog2(seg_count);
+        out << quint16(4) << quint16(16 + 8 * seg_count) << quint16(0) << quint16(seg_count * 2)
+            << quint16(search_range) << quint16(TestLog2(seg_count)) << quint16(seg_count * 2 - search_range);
+        for (auto const &pair : bmp) out << quint16(pair.first);
+        out << quint16(0xFFFF) << quint16(0);
+        for (auto const &pair : bmp) out << quint16(pair.first);
+        out << quint16(0xFFFF);
+        for (auto const &pair : bmp) out << quint16(pair.second - pair.first);
+        out << quint16(1);
+        for (int i = 0; i < seg_count; ++i) out << quint16(0);
+    });
+    auto format12 = TestSfntTable([&mapping](QDataStream &out) {
+        out << quint16(12) << quint16(0) << quint32(16 + 12 * mapping.size()) << quint32(0) << quint32(mapping.size());
+        for (auto const &pair : mapping) out << quint32(pair.first) << quint32(pair.first) << quint32(pair.second);
+    });
+    tables["cmap"] = TestSfntTable([&](QDataStream &out) {
+        out << quint16(0) << quint16(2) << quint16(3) << quint16(1) << quint32(20)
+            << quint16(3) << quint16(10) << quint32(20 + format4.size());
+        out.writeRawData(format4.constData(), format4.size());
+        out.writeRawData(format12.constData(), format12.size());
+    });
+
+    QString postscript = family;
+    postscript.remove(' ');
+    const QVector<QPair<quint16, QString>> names = {
+        {1, family}, {2, QStringLiteral("Regular")}, {3, family}, {4, family}, {6, postscript}};
+    tables["name"] = TestSfntTable([&names](QDataStream &out) {
+        out << quint16(0) << quint16(names.size()) << quint16(6 + 12 * names.size());
+        quint16 offset = 0;
+        for (auto const &name : names) {
+            out << quint16(3) << quint16(1) << quint16(0x0409) << name.first << quint16(name.second.size() * 2)
+                << offset;
+            offset += quint16(name.second.size() * 2);
+        }
+        for (auto const &name : names) {
+            for (auto ch : name.second) out << quint16(ch.unicode());
+        }
+    });
+    tables["post"] = TestSfntTable([](QDataStream &out) {
+        out << quint32(0x00030000) << quint32(0) << qint16(-100) << qint16(50);
+        for (int i = 0; i < 5; ++i) out << quint32(0);
+    });
+
+    auto table_count = tables.size();
+    auto search_range = 16 << TestLog2(table_count);
+    QByteArray font, data;
+    QDataStream out(&font, QIODevice::WriteOnly);
+    out << quint32(0x00010000) << quint16(table_count) << quint16(search_range) << quint16(TestLog2(table_count))
+        << quint16(table_count * 16 - search_range);
+    auto offset = quint32(12 + 16 * table_count);
+    for (auto iter = tables.cbegin(); iter != tables.cend(); ++iter) {
+        auto table = iter.value();
+        table.append(QByteArray((4 - table.size() % 4) % 4, '\0'));
+        quint32 checksum = 0;
+        for (int i = 0; i < table.size(); i += 4) {
+            checksum += quint32(uchar(table[i])) << 24 | quint32(uchar(table[i + 1])) << 16
+                | quint32(uchar(table[i + 2])) << 8 | quint32(uchar(table[i + 3]));
+        }
+        out.writeRawData(iter.key().constData(), 4);
+        out << checksum << quint32(offset + data.size()) << quint32(iter.value().size());
+        data += table;
+    }
+    return font + data;
+}
+
+/**
+ * @brief build the iconfont.cn json of the glyphs
+ */
+static QByteArray TestJsonData(const QString &font_name, const QVector<TestGlyph_t> &glyphs) {
+    QByteArray json = R"({"name": ")" + font_name.toUtf8() + R"(", "description": "", "glyphs": [)";
+    for (int i = 0; i < glyphs.size(); ++i) {
+        auto const &glyph = glyphs[i];
+        if (i > 0) json += ',';
+        json += R"({"icon_id": ")" + glyph.icon_id.toUtf8() + R"(", "name": ")" + glyph.name.toUtf8()
+            + R"(", "font_class": ")" + glyph.font_class.toUtf8() + R"(", "unicode": ")"
+            + QByteArray::number(glyph.codepoint, 16) + R"(", "unicode_decimal": )"
+            + QByteArray::number(glyph.codepoint) + "}";
+    }
+    return json + "]}";
+}
+
+static bool WriteTestFile(const QString &path, const QByteArray &data) {
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+/**
+ * @brief write base.ttf and base.json into the directory
+ */
+static bool WriteTestFont(const QString &base, const QString &family, const QString &font_name,
+                          const QVector<TestGlyph_t> &glyphs) {
+    return WriteTestFile(base + ".ttf", TestFontData(family, glyphs))
+        && WriteTestFile(base + ".json", TestJsonData(font_name, glyphs));
+}
+
+#endif //QTWIDGETS_TESTS_TESTFONT_H_
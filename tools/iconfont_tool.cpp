@@ -0,0 +1,270 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QtIconFont>
+#include "../src/qtglyphjsonreader_p.h"
+#include "../src/qtglyphtable_p.h"
+#include "ttfsubset.h"
+
+FNRICE_QT_WIDGETS_USE_NAMESPACE
+
+// build time helper of QtIconFont, see cmake/QtIconFont.cmake
+
+static const char *const kReservedWords[] = {
+    // c++ keywords
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case",
+    "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const",
+    "consteval", "constexpr", "constinit", "const_cast", "continue", "co_await", "co_return",
+    "co_yield", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+    "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int",
+    "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or",
+    "or_eq", "private", "protected", "public", "register", "reinterpret_cast", "requires", "return",
+    "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch",
+    "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+    "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq",
+    // qt keyword macros
+    "emit", "foreach", "forever", "signals", "slots",
+};
+
+static int Fail(const QString &message) {
+    QTextStream(stderr) << "[QtIconFont_tool] " << message << "\n";
+    return 1;
+}
+
+/**
+ * @brief read the iconfont json with the reader the library uses, so both accept the same files
+ */
+static bool ReadGlyphTable(const QString &path, QtGlyphTable *table, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("Cannot open json file: %1").arg(path);
+        return false;
+    }
+    auto data = file.readAll();
+    QtGlyphJsonReader reader(data.constData(), data.size(), table);
+    if (!reader.read()) {
+        *error = QString("Cannot parse json file: %1, offset: %2, error: %3")
+                     .arg(path).arg(reader.errorOffset()).arg(reader.errorString());
+        return false;
+    }
+    table->build(QtGlyphTable::hashContent(data.constData(), data.size()));
+    return true;
+}
+
+static bool WriteFile(const QString &path, const QByteArray &data, QString *error) {
+    // only touch the file when the content changes, so dependents are not rebuilt
+    QFile old(path);
+    if (old.open(QIODevice::ReadOnly) && old.readAll() == data) return true;
+    old.close();
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        *error = QString("Cannot write file: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+static QString MakeIdentifier(const QString &name) {
+    QString id;
+    id.reserve(name.size() + 1);
+    for (auto ch : name) {
+        auto c = ch.unicode();
+        bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        id.append(valid ? ch : QChar('_'));
+    }
+    if (id.isEmpty()) return id;
+    if (id.at(0).isDigit()) id.prepend('_');
+    for (auto word : kReservedWords) {
+        if (id == QLatin1String(word)) {
+            id.append('_');
+            break;
+        }
+    }
+    return id;
+}
+
+static QString EscapeComment(QString str) {
+    return str.replace('\r', ' ').replace('\n', ' ');
+}
+
+static QString EscapeLiteral(QString str) {
+    return EscapeComment(str.replace('\\', "\\\\").replace('"', "\\\""));
+}
+
+/**
+ * @brief generate a header with a constexpr glyph table from the iconfont json
+ */
+static int GenerateHeader(const QStringList &args) {
+    QCommandLineParser parser;
+    parser.addOption({"namespace", "Namespace of the generated code.", "namespace"});
+    parser.addOption({"output", "Output header file.", "file"});
+    parser.addPositionalArgument("json", "The iconfont json file.");
+    parser.process(args);
+    if (parser.positionalArguments().size() != 1) return Fail("header: expect exactly one json file");
+    auto json_path = parser.positionalArguments().first();
+    auto output = parser.value("output");
+    auto ns = parser.value("namespace");
+    if (output.isEmpty()) return Fail("header: --output is required");
+    if (ns.isEmpty()) ns = MakeIdentifier(QFileInfo(json_path).baseName());
+
+    QtGlyphTable glyphs;
+    QString error;
+    if (!ReadGlyphTable(json_path, &glyphs, &error)) return Fail(error);
+
+    QString enums, table;
+    QHash<QString, QString> identifiers; // identifier -> font class
+    int count = 0;
+    for (int i = 0; i < glyphs.size(); ++i) {
+        auto const &record = glyphs.record(i);
+        auto font_class = glyphs.string(record.font_class).toString();
+        // the reader sets values which are not code points to 0
+        if (font_class.isEmpty() || record.unicode_decimal == 0) continue;
+        auto id = MakeIdentifier(font_class);
+        if (id.isEmpty()) continue;
+        // a renamed enumerator would silently point at another glyph, so names which collide are an error
+        if (identifiers.contains(id)) {
+            return Fail(QString("header: glyphs \"%1\" and \"%2\" both become the identifier %3, rename one of them")
+                            .arg(identifiers.value(id), font_class, id));
+        }
+        identifiers.insert(id, font_class);
+        auto code = QString::number(record.unicode_decimal, 16);
+        enums += QString("    %1 = 0x%2, // %3\n").arg(id, code, EscapeComment(glyphs.string(record.name).toString()));
+        table += QString("    {\"%1\", 0x%2},\n").arg(EscapeLiteral(font_class), code);
+        ++count;
+    }
+
+    auto guard = MakeIdentifier(QFileInfo(output).fileName()).toUpper();
+    QString header;
+    QTextStream out(&header);
+    out << "// generated by QtIconFont_tool from " << QFileInfo(json_path).fileName() << ", do not edit\n"
+        << "#ifndef QTICONFONT_GENERATED_" << guard << "_\n"
+        << "#define QTICONFONT_GENERATED_" << guard << "_\n\n"
+        << "#include <QString>\n\n"
+        << "namespace " << ns << " {\n\n"
+        << "inline constexpr const char *kFontName = \"" << EscapeLiteral(glyphs.fontName()) << "\";\n\n"
+        << "enum class Glyph : char32_t {\n" << enums << "};\n\n"
+        << "struct GlyphInfo_t {\n"
+        << "    const char *font_class;\n"
+        << "    char32_t unicode_decimal;\n"
+        << "};\n\n"
+        << "inline constexpr int kGlyphCount = " << count << ";\n"
+        << "inline constexpr GlyphInfo_t kGlyphs[kGlyphCount + 1] = {\n" << table << "    {nullptr, 0},\n};\n\n"
+        << "constexpr char32_t codepoint(Glyph glyph) noexcept {\n"
+        << "    return static_cast<char32_t>(glyph);\n"
+        << "}\n\n"
+        << "inline QString toString(Glyph glyph) {\n"
+        << "    auto code = codepoint(glyph);\n"
+        << "    return QString::fromUcs4(&code, 1);\n"
+        << "}\n\n"
+        << "} // namespace " << ns << "\n\n"
+        << "#endif\n";
+    out.flush();
+    if (!WriteFile(output, header.toUtf8(), &error)) return Fail(error);
+    return 0;
+}
+
+/**
+ * @brief convert the iconfont json to a binary manifest
+ */
+static int CompileManifest(const QStringList &args) {
+    QCommandLineParser parser;
+    parser.addOption({"output", "Output manifest file.", "file"});
+    parser.addPositionalArgument("json", "The iconfont json file.");
+    parser.process(args);
+    if (parser.positionalArguments().size() != 1) return Fail("compile: expect exactly one json file");
+    auto output = parser.value("output");
+    if (output.isEmpty()) return Fail("compile: --output is required");
+    if (!QtIconFont::CompileManifest(parser.positionalArguments().first(), output)) {
+        return Fail("compile: failed");
+    }
+    return 0;
+}
+
+/**
+ * @brief read class names, one per line, empty lines and lines starting with '#' are ignored
+ */
+static bool ReadClassList(const QString &path, QStringList *classes, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = QString("Cannot open class list file: %1").arg(path);
+        return false;
+    }
+    while (!file.atEnd()) {
+        auto line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        classes->append(line);
+    }
+    return true;
+}
+
+/**
+ * @brief subset the font and the json to the used glyphs, emit a reduced font and a matching manifest
+ */
+static int Subset(const QStringList &args) {
+    QCommandLineParser parser;
+    parser.addOption({"font", "The font file to subset.", "file"});
+    parser.addOption({"class", "Class name of a used glyph, can be repeated.", "name"});
+    parser.addOption({"classes-file", "File of used class names, one per line.", "file"});
+    parser.addOption({"output-font", "Output font file.", "file"});
+    parser.addOption({"output-manifest", "Output manifest file.", "file"});
+    parser.addPositionalArgument("json", "The iconfont json file.");
+    parser.process(args);
+    if (parser.positionalArguments().size() != 1) return Fail("subset: expect exactly one json file");
+    auto json_path = parser.positionalArguments().first();
+    auto font_path = parser.value("font");
+    auto output_font = parser.value("output-font");
+    auto output_manifest = parser.value("output-manifest");
+    if (font_path.isEmpty() || output_font.isEmpty() || output_manifest.isEmpty()) {
+        return Fail("subset: --font, --output-font and --output-manifest are required");
+    }
+
+    QString error;
+    auto classes = parser.values("class");
+    for (auto const &path : parser.values("classes-file")) {
+        if (!ReadClassList(path, &classes, &error)) return Fail(error);
+    }
+    classes.removeDuplicates();
+    if (classes.isEmpty()) return Fail("subset: no class names, use --class or --classes-file");
+
+    QtGlyphTable glyphs;
+    if (!ReadGlyphTable(json_path, &glyphs, &error)) return Fail(error);
+    QVector<uint> used;
+    for (auto const &font_class : classes) {
+        auto i = glyphs.find(QtGlyphTable::FontClassIndex, QStringView(font_class));
+        if (i < 0) return Fail(QString("subset: glyph not found: %1").arg(font_class));
+        used.append(glyphs.record(i).unicode_decimal);
+    }
+
+    QFile font_file(font_path);
+    if (!font_file.open(QIODevice::ReadOnly)) return Fail(QString("Cannot open font file: %1").arg(font_path));
+    QByteArray subset;
+    if (!SubsetFont(font_file.readAll(), used, &subset, &error)) {
+        return Fail(QString("subset: %1: %2").arg(font_path, error));
+    }
+    if (!WriteFile(output_font, subset, &error)) return Fail(error);
+    if (!QtIconFont::CompileManifest(json_path, output_manifest, classes)) return Fail("subset: failed");
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QtIconFont_tool");
+
+    auto args = QCoreApplication::arguments();
+    auto usage = QString("usage: %1 <command> [options]\n"
+                         "commands:\n"
+                         "  header    generate a constexpr glyph header from the iconfont json\n"
+                         "  compile   convert the iconfont json to a binary manifest\n"
+                         "  subset    reduce the font and the manifest to the used glyphs\n")
+        .arg(QFileInfo(args.first()).fileName());
+    if (args.size() < 2) return Fail(usage);
+    auto command = args.takeAt(1);
+    if (command == "header") return GenerateHeader(args);
+    if (command == "compile") return CompileManifest(args);
+    if (command == "subset") return Subset(args);
+    return Fail(usage);
+}
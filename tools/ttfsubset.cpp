@@ -0,0 +1,389 @@
+#include "ttfsubset.h"
+#include <QMap>
+#include <QSet>
+#include <algorithm>
+
+// sfnt values are big-endian, every read is bounds checked against the table it reads from
+
+struct Table_t {
+    quint32 tag;
+    QByteArray data;
+};
+
+struct Mapping_t {
+    uint codepoint;
+    quint16 glyph;
+};
+
+static constexpr quint32 MakeTag(char a, char b, char c, char d) {
+    return quint32(uchar(a)) << 24 | quint32(uchar(b)) << 16 | quint32(uchar(c)) << 8 | quint32(uchar(d));
+}
+
+static auto constexpr kTagCmap = MakeTag('c', 'm', 'a', 'p');
+static auto constexpr kTagDsig = MakeTag('D', 'S', 'I', 'G');
+static auto constexpr kTagGlyf = MakeTag('g', 'l', 'y', 'f');
+static auto constexpr kTagHead = MakeTag('h', 'e', 'a', 'd');
+static auto constexpr kTagLoca = MakeTag('l', 'o', 'c', 'a');
+static auto constexpr kTagMaxp = MakeTag('m', 'a', 'x', 'p');
+static auto constexpr kTagPost = MakeTag('p', 'o', 's', 't');
+
+static auto constexpr kChecksumMagic = 0xB1B0AFBAu;
+
+// composite glyph flags
+static auto constexpr kArg1And2AreWords = 0x0001;
+static auto constexpr kWeHaveAScale = 0x0008;
+static auto constexpr kMoreComponents = 0x0020;
+static auto constexpr kWeHaveAnXAndYScale = 0x0040;
+static auto constexpr kWeHaveATwoByTwo = 0x0080;
+
+static bool InRange(const QByteArray &data, quint64 offset, quint64 length) {
+    return offset + length <= quint64(data.size());
+}
+
+static quint16 ReadU16(const QByteArray &data, quint32 pos) {
+    auto p = reinterpret_cast<const uchar *>(data.constData()) + pos;
+    return quint16(p[0] << 8 | p[1]);
+}
+
+static quint32 ReadU32(const QByteArray &data, quint32 pos) {
+    auto p = reinterpret_cast<const uchar *>(data.constData()) + pos;
+    return quint32(p[0]) << 24 | quint32(p[1]) << 16 | quint32(p[2]) << 8 | quint32(p[3]);
+}
+
+static void AppendU16(QByteArray *out, quint16 value) {
+    out->append(char(value >> 8));
+    out->append(char(value));
+}
+
+static void AppendU32(QByteArray *out, quint32 value) {
+    AppendU16(out, quint16(value >> 16));
+    AppendU16(out, quint16(value));
+}
+
+static void WriteU16(QByteArray *out, int pos, quint16 value) {
+    (*out)[pos] = char(value >> 8);
+    (*out)[pos + 1] = char(value);
+}
+
+static void WriteU32(QByteArray *out, int pos, quint32 value) {
+    WriteU16(out, pos, quint16(value >> 16));
+    WriteU16(out, pos + 2, quint16(value));
+}
+
+static void PadTo4(QByteArray *out) {
+    while (out->size() % 4 != 0) out->append('\0');
+}
+
+static quint32 Checksum(const QByteArray &data) {
+    quint32 sum = 0;
+    int i = 0;
+    for (; i + 4 <= data.size(); i += 4) sum += ReadU32(data, quint32(i));
+    if (i < data.size()) {
+        QByteArray tail = data.mid(i);
+        PadTo4(&tail);
+        sum += ReadU32(tail, 0);
+    }
+    return sum;
+}
+
+static int Log2(int value) {
+    int log = 0;
+    while ((2 << log) <= value) ++log;
+    return log;
+}
+
+static quint16 LookupFormat4(const QByteArray &sub, uint codepoint) {
+    if (codepoint > 0xFFFF || !InRange(sub, 0, 14)) return 0;
+    quint32 seg_x2 = ReadU16(sub, 6);
+    auto end_codes = 14u;
+    auto start_codes = end_codes + seg_x2 + 2;
+    auto id_deltas = start_codes + seg_x2;
+    auto id_range_offsets = id_deltas + seg_x2;
+    if (!InRange(sub, id_range_offsets, seg_x2)) return 0;
+    for (quint32 i = 0; i < seg_x2; i += 2) {
+        if (ReadU16(sub, end_codes + i) < codepoint) continue;
+        auto start = ReadU16(sub, start_codes + i);
+        if (start > codepoint) return 0;
+        auto delta = ReadU16(sub, id_deltas + i);
+        auto range_offset = ReadU16(sub, id_range_offsets + i);
+        if (range_offset == 0) return quint16(codepoint + delta);
+        auto pos = id_range_offsets + i + range_offset + 2 * (codepoint - start);
+        if (!InRange(sub, pos, 2)) return 0;
+        auto glyph = ReadU16(sub, pos);
+        return glyph == 0 ? 0 : quint16(glyph + delta);
+    }
+    return 0;
+}
+
+static quint16 LookupFormat12(const QByteArray &sub, uint codepoint) {
+    if (!InRange(sub, 0, 16)) return 0;
+    auto groups = ReadU32(sub, 12);
+    if (!InRange(sub, 16, quint64(groups) * 12)) return 0;
+    for (quint32 i = 0; i < groups; ++i) {
+        auto pos = 16 + i * 12;
+        auto start = ReadU32(sub, pos);
+        auto end = ReadU32(sub, pos + 4);
+        if (codepoint < start || codepoint > end) continue;
+        auto glyph = ReadU32(sub, pos + 8) + (codepoint - start);
+        return glyph > 0xFFFF ? 0 : quint16(glyph);
+    }
+    return 0;
+}
+
+/**
+ * @brief get unicode subtables of cmap, sorted by preference
+ */
+static QVector<QByteArray> UnicodeSubtables(const QByteArray &cmap) {
+    QMultiMap<int, QByteArray> ranked;
+    if (!InRange(cmap, 0, 4)) return {};
+    auto count = ReadU16(cmap, 2);
+    if (!InRange(cmap, 4, quint64(count) * 8)) return {};
+    for (quint32 i = 0; i < count; ++i) {
+        auto platform = ReadU16(cmap, 4 + i * 8);
+        auto encoding = ReadU16(cmap, 4 + i * 8 + 2);
+        auto offset = ReadU32(cmap, 4 + i * 8 + 4);
+        if (!InRange(cmap, offset, 8)) continue;
+        auto format = ReadU16(cmap, offset);
+        auto unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+        auto symbol = platform == 3 && encoding == 0;
+        if (format == 12 && unicode) {
+            auto length = ReadU32(cmap, offset + 4);
+            if (InRange(cmap, offset, length)) ranked.insert(0, cmap.mid(int(offset), int(length)));
+        } else if (format == 4 && (unicode || symbol)) {
+            auto length = ReadU16(cmap, offset + 2);
+            if (InRange(cmap, offset, length)) ranked.insert(unicode ? 1 : 2, cmap.mid(int(offset), length));
+        }
+    }
+    return ranked.values().toVector();
+}
+
+static QByteArray BuildCmap(const QVector<Mapping_t> &mappings) {
+    struct Run_t {
+        uint start, end;
+        quint16 glyph;
+    };
+    // runs of consecutive code points mapped to consecutive glyphs
+    QVector<Run_t> runs;
+    for (auto const &mapping : mappings) {
+        if (!runs.isEmpty()) {
+            auto &last = runs.last();
+            if (mapping.codepoint == last.end + 1 && mapping.glyph == last.glyph + (last.end - last.start) + 1) {
+                last.end = mapping.codepoint;
+                continue;
+            }
+        }
+        runs.append({mapping.codepoint, mapping.codepoint, mapping.glyph});
+    }
+
+    // format 4 for the bmp, 0xFFFF is reserved for the last segment
+    QVector<Run_t> segments;
+    for (auto run : runs) {
+        if (run.start >= 0xFFFF) break;
+        run.end = qMin(run.end, 0xFFFEu);
+        segments.append(run);
+    }
+    segments.append({0xFFFF, 0xFFFF, 1});
+    auto seg_count = segments.size();
+    QByteArray format4;
+    AppendU16(&format4, 4);
+    AppendU16(&format4, 0); // length, written below
+    AppendU16(&format4, 0); // language
+    AppendU16(&format4, quint16(seg_count * 2));
+    auto search_range = 2 << Log2(seg_count);
+    AppendU16(&format4, quint16(search_range));
+    AppendU16(&format4, quint16(Log2(seg_count)));
+    AppendU16(&format4, quint16(seg_count * 2 - search_range));
+    for (auto const &segment : segments) AppendU16(&format4, quint16(segment.end));
+    AppendU16(&format4, 0); // reserved pad
+    for (auto const &segment : segments) AppendU16(&format4, quint16(segment.start));
+    for (auto const &segment : segments) {
+        // the last segment maps 0xFFFF to glyph 0
+        AppendU16(&format4, segment.start == 0xFFFF ? 1 : quint16(segment.glyph - segment.start));
+    }
+    for (int i = 0; i < seg_count; ++i) AppendU16(&format4, 0);
+    WriteU16(&format4, 2, quint16(format4.size()));
+
+    // format 12 for all code points
+    QByteArray format12;
+    AppendU16(&format12, 12);
+    AppendU16(&format12, 0); // reserved
+    AppendU32(&format12, quint32(16 + runs.size() * 12));
+    AppendU32(&format12, 0); // language
+    AppendU32(&format12, quint32(runs.size()));
+    for (auto const &run : runs) {
+        AppendU32(&format12, run.start);
+        AppendU32(&format12, run.end);
+        AppendU32(&format12, run.glyph);
+    }
+
+    QByteArray cmap;
+    AppendU16(&cmap, 0); // version
+    AppendU16(&cmap, 2);
+    AppendU16(&cmap, 3); // windows, unicode bmp
+    AppendU16(&cmap, 1);
+    AppendU32(&cmap, 20);
+    AppendU16(&cmap, 3); // windows, unicode full repertoire
+    AppendU16(&cmap, 10);
+    AppendU32(&cmap, quint32(20 + format4.size()));
+    cmap.append(format4);
+    cmap.append(format12);
+    return cmap;
+}
+
+bool SubsetFont(const QByteArray &font, const QVector<uint> &codepoints, QByteArray *output, QString *error) {
+    // ------ table directory
+    if (!InRange(font, 0, 12)) {
+        *error = "Font is truncated";
+        return false;
+    }
+    auto version = ReadU32(font, 0);
+    if (version == MakeTag('O', 'T', 'T', 'O')) {
+        *error = "CFF-based OpenType fonts are not supported";
+        return false;
+    }
+    if (version == MakeTag('t', 't', 'c', 'f')) {
+        *error = "Font collections are not supported";
+        return false;
+    }
+    if (version != 0x00010000 && version != MakeTag('t', 'r', 'u', 'e')) {
+        *error = "Not a TrueType font";
+        return false;
+    }
+    auto table_count = ReadU16(font, 4);
+    if (!InRange(font, 12, quint64(table_count) * 16)) {
+        *error = "Font is truncated";
+        return false;
+    }
+    QVector<Table_t> tables;
+    for (quint32 i = 0; i < table_count; ++i) {
+        auto record = 12 + i * 16;
+        auto tag = ReadU32(font, record);
+        auto offset = ReadU32(font, record + 8);
+        auto length = ReadU32(font, record + 12);
+        if (!InRange(font, offset, length)) {
+            *error = "Font is corrupted";
+            return false;
+        }
+        if (tag == kTagDsig) continue; // the signature is invalid after subsetting
+        tables.append({tag, font.mid(int(offset), int(length))});
+    }
+    auto find = [&tables](quint32 tag) -> Table_t * {
+        auto it = std::find_if(tables.begin(), tables.end(), [tag](const Table_t &t) { return t.tag == tag; });
+        return it == tables.end() ? nullptr : &*it;
+    };
+    auto head = find(kTagHead), maxp = find(kTagMaxp), loca = find(kTagLoca), glyf = find(kTagGlyf);
+    auto cmap = find(kTagCmap);
+    if (!head || !maxp || !loca || !glyf || !cmap) {
+        *error = "Font has no glyf outlines, head, maxp, loca or cmap table is missing";
+        return false;
+    }
+    if (!InRange(head->data, 0, 54) || !InRange(maxp->data, 0, 6)) {
+        *error = "Font is corrupted";
+        return false;
+    }
+    auto glyph_count = ReadU16(maxp->data, 4);
+    auto long_loca = ReadU16(head->data, 50) != 0;
+    if (!InRange(loca->data, 0, quint64(glyph_count + 1) * (long_loca ? 4 : 2))) {
+        *error = "Font is corrupted";
+        return false;
+    }
+    auto glyph_offset = [&](quint32 glyph) -> quint32 {
+        return long_loca ? ReadU32(loca->data, glyph * 4) : quint32(ReadU16(loca->data, glyph * 2)) * 2;
+    };
+
+    // ------ map code points
+    auto subtables = UnicodeSubtables(cmap->data);
+    QMap<uint, quint16> mapped;
+    for (auto codepoint : codepoints) {
+        quint16 glyph = 0;
+        for (auto const &sub : subtables) {
+            glyph = ReadU16(sub, 0) == 12 ? LookupFormat12(sub, codepoint) : LookupFormat4(sub, codepoint);
+            if (glyph != 0) break;
+        }
+        if (glyph == 0 || glyph >= glyph_count) {
+            *error = QString("Code point U+%1 is not in the font")
+                .arg(QString::number(codepoint, 16).toUpper().rightJustified(4, '0'));
+            return false;
+        }
+        mapped.insert(codepoint, glyph);
+    }
+
+    // ------ keep glyphs and the components of composite glyphs, .notdef is always kept
+    QSet<quint16> keep;
+    QVector<quint16> pending{0};
+    for (auto glyph : mapped) pending.append(glyph);
+    while (!pending.isEmpty()) {
+        auto glyph = pending.takeLast();
+        if (keep.contains(glyph)) continue;
+        keep.insert(glyph);
+        auto start = glyph_offset(glyph), end = glyph_offset(glyph + 1u);
+        if (end <= start || !InRange(glyf->data, start, end - start)) continue;
+        auto data = glyf->data.mid(int(start), int(end - start));
+        if (data.size() < 10 || qint16(ReadU16(data, 0)) >= 0) continue;
+        quint32 pos = 10;
+        while (InRange(data, pos, 4)) {
+            auto flags = ReadU16(data, pos);
+            auto component = ReadU16(data, pos + 2);
+            if (component < glyph_count) pending.append(component);
+            pos += 4 + ((flags & kArg1And2AreWords) ? 4 : 2);
+            if (flags & kWeHaveAScale) pos += 2;
+            else if (flags & kWeHaveAnXAndYScale) pos += 4;
+            else if (flags & kWeHaveATwoByTwo) pos += 8;
+            if (!(flags & kMoreComponents)) break;
+        }
+    }
+
+    // ------ rewrite glyf and loca, unused glyphs become empty, glyph ids are kept
+    QByteArray new_glyf, new_loca;
+    for (quint32 glyph = 0; glyph < glyph_count; ++glyph) {
+        AppendU32(&new_loca, quint32(new_glyf.size()));
+        if (!keep.contains(quint16(glyph))) continue;
+        auto start = glyph_offset(glyph), end = glyph_offset(glyph + 1);
+        if (end <= start || !InRange(glyf->data, start, end - start)) continue;
+        new_glyf.append(glyf->data.constData() + start, int(end - start));
+        PadTo4(&new_glyf);
+    }
+    AppendU32(&new_loca, quint32(new_glyf.size()));
+    glyf->data = new_glyf;
+    loca->data = new_loca;
+    WriteU16(&head->data, 50, 1); // long loca
+    WriteU32(&head->data, 8, 0); // checkSumAdjustment, written below
+
+    QVector<Mapping_t> mappings;
+    for (auto it = mapped.cbegin(); it != mapped.cend(); ++it) mappings.append({it.key(), it.value()});
+    cmap->data = BuildCmap(mappings);
+
+    // glyph names of all glyphs are dropped
+    if (auto post = find(kTagPost); post && post->data.size() >= 32) {
+        post->data.truncate(32);
+        WriteU32(&post->data, 0, 0x00030000);
+    }
+
+    // ------ write the font, tables are sorted by tag
+    std::sort(tables.begin(), tables.end(), [](const Table_t &a, const Table_t &b) { return a.tag < b.tag; });
+    auto count = tables.size();
+    auto search_range = 16 << Log2(count);
+    QByteArray out;
+    AppendU32(&out, version);
+    AppendU16(&out, quint16(count));
+    AppendU16(&out, quint16(search_range));
+    AppendU16(&out, quint16(Log2(count)));
+    AppendU16(&out, quint16(count * 16 - search_range));
+    auto offset = quint32(12 + count * 16);
+    int head_offset = 0;
+    for (auto const &table : tables) {
+        AppendU32(&out, table.tag);
+        AppendU32(&out, Checksum(table.data));
+        AppendU32(&out, offset);
+        AppendU32(&out, quint32(table.data.size()));
+        if (table.tag == kTagHead) head_offset = int(offset);
+        offset += quint32((table.data.size() + 3) & ~3);
+    }
+    for (auto const &table : tables) {
+        out.append(table.data);
+        PadTo4(&out);
+    }
+    WriteU32(&out, head_offset + 8, kChecksumMagic - Checksum(out));
+    *output = out;
+    return true;
+}
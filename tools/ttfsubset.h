@@ -0,0 +1,22 @@
+#ifndef QTWIDGETS_TOOLS_TTFSUBSET_H_
+#define QTWIDGETS_TOOLS_TTFSUBSET_H_
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief subset a TrueType font to the glyphs mapped from the given code points.
+ *
+ * glyph ids are kept, outlines of unused glyphs are emptied, so hmtx, GSUB and other tables indexed by
+ * glyph id stay valid without renumbering. composite glyphs keep their components. cmap is rewritten with
+ * only the given code points, post is reduced to format 3 and DSIG is dropped.
+ * @param [in] font TrueType font data, CFF-based OpenType fonts and collections are not supported
+ * @param [in] codepoints code points to keep
+ * @param [out] output subset font data
+ * @param [out] error error message if failed
+ * @return
+ */
+bool SubsetFont(const QByteArray &font, const QVector<uint> &codepoints, QByteArray *output, QString *error);
+
+#endif //QTWIDGETS_TOOLS_TTFSUBSET_H_